@@ -31,6 +31,9 @@
 #include <QtWidgets/qpushbutton.h>
 #include "core/utilities.h"
 #include "core/framelesshelper.h"
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+#include "core/themewatcher.h"
+#endif
 
 FRAMELESSHELPER_USE_NAMESPACE
 
@@ -82,6 +85,12 @@ Widget::Widget(QWidget *parent) : QWidget(parent)
     createWinId();
     setupUi();
     startTimer(500);
+#if defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
+    connect(ThemeWatcher::instance(), &ThemeWatcher::themeChanged, this, [this](){
+        updateStyleSheet();
+        updateSystemButtonIcons();
+    });
+#endif
 }
 
 Widget::~Widget() = default;
@@ -0,0 +1,213 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "clientsidemoveresize.h"
+#include <QtCore/qdebug.h>
+#include <QtGui/qevent.h>
+#include <QtGui/qscreen.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+ClientSideMoveResize::ClientSideMoveResize(QObject *parent) : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &ClientSideMoveResize::applyPendingGeometry);
+}
+
+ClientSideMoveResize::~ClientSideMoveResize()
+{
+    stop();
+}
+
+void ClientSideMoveResize::startMove(QWindow *window, const QPoint &globalPos)
+{
+    start(window, globalPos, Qt::NoSection);
+}
+
+void ClientSideMoveResize::startResize(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection)
+{
+    start(window, globalPos, frameSection);
+}
+
+void ClientSideMoveResize::start(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+
+    stop();
+
+    m_window = window;
+    m_frameSection = frameSection;
+    m_startPos = globalPos;
+    m_startGeometry = window->geometry();
+    m_geometryPending = false;
+
+    window->installEventFilter(this);
+    // Without the grab the release may go elsewhere and the drag never ends.
+    if (!window->setMouseGrabEnabled(true)) {
+        qWarning() << "Failed to grab the mouse for" << window;
+        stop();
+    }
+}
+
+void ClientSideMoveResize::stop()
+{
+    // Cleared first, ending the grab may send events to the filter.
+    QWindow *window = m_window.data();
+    if (!window) {
+        return;
+    }
+    m_window.clear();
+
+    m_timer.stop();
+    if (m_geometryPending) {
+        m_geometryPending = false;
+        window->setGeometry(m_pendingGeometry);
+    }
+
+    window->removeEventFilter(this);
+    window->setMouseGrabEnabled(false);
+}
+
+/*!
+    The geometry for the pointer at \a globalPos, anchored at the edges
+    opposite to the dragged ones.
+ */
+QRect ClientSideMoveResize::geometryForPos(const QPoint &globalPos) const
+{
+    const QPoint delta = globalPos - m_startPos;
+    QRect geometry = m_startGeometry;
+
+    if (m_frameSection == Qt::NoSection) {
+        geometry.moveTopLeft(m_startGeometry.topLeft() + delta);
+        return geometry;
+    }
+
+    const QSize minSize = m_window->minimumSize().expandedTo(QSize(1, 1));
+    const QSize maxSize = m_window->maximumSize();
+
+    const bool left = m_frameSection == Qt::LeftSection
+            || m_frameSection == Qt::TopLeftSection || m_frameSection == Qt::BottomLeftSection;
+    const bool right = m_frameSection == Qt::RightSection
+            || m_frameSection == Qt::TopRightSection || m_frameSection == Qt::BottomRightSection;
+    const bool top = m_frameSection == Qt::TopSection
+            || m_frameSection == Qt::TopLeftSection || m_frameSection == Qt::TopRightSection;
+    const bool bottom = m_frameSection == Qt::BottomSection
+            || m_frameSection == Qt::BottomLeftSection || m_frameSection == Qt::BottomRightSection;
+
+    if (left || right) {
+        const int width = qBound(minSize.width(),
+                                 m_startGeometry.width() + (left ? -delta.x() : delta.x()),
+                                 maxSize.width());
+        if (left) {
+            geometry.setLeft(m_startGeometry.right() + 1 - width);
+        } else {
+            geometry.setWidth(width);
+        }
+    }
+
+    if (top || bottom) {
+        const int height = qBound(minSize.height(),
+                                  m_startGeometry.height() + (top ? -delta.y() : delta.y()),
+                                  maxSize.height());
+        if (top) {
+            geometry.setTop(m_startGeometry.bottom() + 1 - height);
+        } else {
+            geometry.setHeight(height);
+        }
+    }
+
+    return geometry;
+}
+
+void ClientSideMoveResize::applyPendingGeometry()
+{
+    if (m_window.isNull() || !m_geometryPending) {
+        return;
+    }
+
+    m_geometryPending = false;
+    m_window->setGeometry(m_pendingGeometry);
+
+    // Nothing else until the next refresh, later moves are merged meanwhile.
+    const QScreen *screen = m_window->screen();
+    const qreal refreshRate = (screen && screen->refreshRate() > 0) ? screen->refreshRate() : 60.0;
+    m_timer.start(qMax(1, qRound(1000.0 / refreshRate)));
+}
+
+bool ClientSideMoveResize::eventFilter(QObject *object, QEvent *event)
+{
+    if (object != m_window) {
+        return false;
+    }
+
+    switch (event->type())
+    {
+    case QEvent::MouseMove:
+    case QEvent::NonClientAreaMouseMove:
+    {
+        auto ev = static_cast<QMouseEvent *>(event);
+        if (ev->buttons() == Qt::NoButton) {
+            // The release went somewhere else.
+            stop();
+            return false;
+        }
+        m_pendingGeometry = geometryForPos(ev->globalPos());
+        m_geometryPending = true;
+        if (!m_timer.isActive()) {
+            applyPendingGeometry();
+        }
+        return true;
+    }
+    case QEvent::MouseButtonRelease:
+    case QEvent::NonClientAreaMouseButtonRelease:
+        // Let the release through, the frameless helper resets its state on it.
+        stop();
+        break;
+    case QEvent::KeyPress:
+        if (static_cast<QKeyEvent *>(event)->key() == Qt::Key_Escape) {
+            // Cancelled, back to where it started.
+            m_pendingGeometry = m_startGeometry;
+            m_geometryPending = true;
+            stop();
+            return true;
+        }
+        break;
+    case QEvent::UngrabMouse:
+    case QEvent::FocusOut:
+    case QEvent::WindowDeactivate:
+    case QEvent::Hide:
+        // The drag can't be finished any more.
+        stop();
+        break;
+    default:
+        break;
+    }
+
+    return false;
+}
+
+FRAMELESSHELPER_END_NAMESPACE
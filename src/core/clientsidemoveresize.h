@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qobject.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qtimer.h>
+#include <QtGui/qwindow.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    Moves and resizes a window without the help of the window manager, for
+    sessions where _NET_WM_MOVERESIZE does nothing (no window manager, or
+    one that doesn't follow the EWMH).
+
+    The mouse is grabbed until the button is released, and the new
+    geometry is computed from the pointer offset and the dragged frame
+    section, within the minimum and maximum size of the window. Geometry
+    changes are coalesced to at most one per refresh of the screen.
+
+    The drag also ends when the grab fails or is lost, when the window is
+    hidden or loses the focus, and on a move without a pressed button.
+    Escape cancels it.
+ */
+class FRAMELESSHELPER_API ClientSideMoveResize : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(ClientSideMoveResize)
+
+public:
+    explicit ClientSideMoveResize(QObject *parent = nullptr);
+    ~ClientSideMoveResize() override;
+
+    void startMove(QWindow *window, const QPoint &globalPos);
+    void startResize(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection);
+    void stop();
+
+    bool isActive() const { return !m_window.isNull(); }
+
+protected:
+    bool eventFilter(QObject *object, QEvent *event) override;
+
+private:
+    void start(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection);
+    QRect geometryForPos(const QPoint &globalPos) const;
+    void applyPendingGeometry();
+
+    QPointer<QWindow> m_window;
+    // Qt::NoSection for a move.
+    Qt::WindowFrameSection m_frameSection = Qt::NoSection;
+    QPoint m_startPos;
+    QRect m_startGeometry;
+    QRect m_pendingGeometry;
+    bool m_geometryPending = false;
+    QTimer m_timer;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,257 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "dragregionmap.h"
+#include <algorithm>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+int DragRegionMap::add(const QRect &rect, const bool draggable, const int priority)
+{
+    const int id = m_nextId++;
+    Region region;
+    region.rect = rect.normalized();
+    region.draggable = draggable;
+    region.priority = priority;
+    m_regions.insert(id, region);
+    addEdges(region.rect);
+    markDirty(region.rect);
+    return id;
+}
+
+bool DragRegionMap::update(const int id, const QRect &rect)
+{
+    const auto it = m_regions.find(id);
+    if (it == m_regions.end()) {
+        return false;
+    }
+    const QRect newRect = rect.normalized();
+    if (it->rect == newRect) {
+        return true;
+    }
+    // Both the old and the new area have to be recompiled.
+    markDirty(it->rect);
+    removeEdges(it->rect);
+    it->rect = newRect;
+    addEdges(newRect);
+    markDirty(newRect);
+    return true;
+}
+
+bool DragRegionMap::remove(const int id)
+{
+    const auto it = m_regions.find(id);
+    if (it == m_regions.end()) {
+        return false;
+    }
+    markDirty(it->rect);
+    removeEdges(it->rect);
+    m_regions.erase(it);
+    return true;
+}
+
+void DragRegionMap::clear()
+{
+    m_regions.clear();
+    m_edges.clear();
+    m_bands.clear();
+    m_dirty = false;
+}
+
+void DragRegionMap::addEdges(const QRect &rect)
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+    ++m_edges[rect.top()];
+    ++m_edges[rect.top() + rect.height()];
+}
+
+void DragRegionMap::removeEdges(const QRect &rect)
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+    for (const int edge : {rect.top(), rect.top() + rect.height()}) {
+        const auto it = m_edges.find(edge);
+        if (it != m_edges.end() && --it.value() <= 0) {
+            m_edges.erase(it);
+        }
+    }
+}
+
+void DragRegionMap::markDirty(const QRect &rect)
+{
+    if (rect.isEmpty()) {
+        return;
+    }
+    const int top = rect.top();
+    const int bottom = rect.top() + rect.height();
+    if (m_dirty) {
+        m_dirtyTop = qMin(m_dirtyTop, top);
+        m_dirtyBottom = qMax(m_dirtyBottom, bottom);
+    } else {
+        m_dirty = true;
+        m_dirtyTop = top;
+        m_dirtyBottom = bottom;
+    }
+}
+
+void DragRegionMap::compileBand(const int top, const int bottom, QVector<Band> &bands) const
+{
+    struct Cover
+    {
+        int left;
+        int right;
+        bool draggable;
+        int priority;
+    };
+
+    QVector<Cover> covers;
+    QVector<int> xEdges;
+    for (const Region &region : m_regions) {
+        const QRect &rect = region.rect;
+        // Bands never cross an edge, so a region covers all of it or nothing.
+        if (rect.isEmpty() || rect.top() > top || (rect.top() + rect.height()) < bottom) {
+            continue;
+        }
+        const int right = rect.left() + rect.width();
+        covers.append({rect.left(), right, region.draggable, region.priority});
+        xEdges.append(rect.left());
+        xEdges.append(right);
+    }
+    if (covers.isEmpty()) {
+        return;
+    }
+
+    std::sort(xEdges.begin(), xEdges.end());
+    xEdges.erase(std::unique(xEdges.begin(), xEdges.end()), xEdges.end());
+
+    Band band = {top, bottom, {}};
+    for (int i = 0; i + 1 < xEdges.size(); ++i) {
+        const int left = xEdges.at(i);
+        const int right = xEdges.at(i + 1);
+        const Cover *winner = nullptr;
+        for (const Cover &cover : qAsConst(covers)) {
+            if (cover.left > left || cover.right < right) {
+                continue;
+            }
+            if (!winner || (cover.priority > winner->priority)
+                    || ((cover.priority == winner->priority) && !cover.draggable)) {
+                winner = &cover;
+            }
+        }
+        if (!winner) {
+            continue;
+        }
+        if (!band.spans.isEmpty() && (band.spans.last().right == left)
+                && (band.spans.last().draggable == winner->draggable)) {
+            band.spans.last().right = right;
+        } else {
+            band.spans.append({left, right, winner->draggable});
+        }
+    }
+    bands.append(band);
+}
+
+void DragRegionMap::compile()
+{
+    if (!m_dirty) {
+        return;
+    }
+    m_dirty = false;
+
+    int top = m_dirtyTop;
+    int bottom = m_dirtyBottom;
+
+    // Bands which straddle the dirty range are recompiled as well.
+    const auto first = std::lower_bound(m_bands.begin(), m_bands.end(), top,
+        [](const Band &band, const int value) { return band.bottom <= value; });
+    auto last = first;
+    while (last != m_bands.end() && last->top < bottom) {
+        top = qMin(top, last->top);
+        bottom = qMax(bottom, last->bottom);
+        ++last;
+    }
+
+    QVector<Band> bands;
+    int bandTop = top;
+    for (auto it = m_edges.upperBound(top); bandTop < bottom; ++it) {
+        const int bandBottom = (it == m_edges.end()) ? bottom : qMin(it.key(), bottom);
+        compileBand(bandTop, bandBottom, bands);
+        bandTop = bandBottom;
+        if (it == m_edges.end()) {
+            break;
+        }
+    }
+
+    const int index = static_cast<int>(first - m_bands.begin());
+    m_bands.erase(first, last);
+    for (int i = 0; i != bands.size(); ++i) {
+        m_bands.insert(index + i, bands.at(i));
+    }
+}
+
+DragRegionMap::Hit DragRegionMap::hitTest(const QPoint &pos)
+{
+    compile();
+
+    const int x = pos.x();
+    const int y = pos.y();
+
+    const auto band = std::upper_bound(m_bands.cbegin(), m_bands.cend(), y,
+        [](const int value, const Band &b) { return value < b.bottom; });
+    if (band == m_bands.cend() || y < band->top) {
+        return Hit::None;
+    }
+
+    const auto span = std::upper_bound(band->spans.cbegin(), band->spans.cend(), x,
+        [](const int value, const Span &s) { return value < s.right; });
+    if (span == band->spans.cend() || x < span->left) {
+        return Hit::None;
+    }
+
+    return span->draggable ? Hit::Draggable : Hit::Excluded;
+}
+
+void DragRegionMap::applyTo(SpanRegion &region, const bool draggable)
+{
+    compile();
+
+    for (const Band &band : qAsConst(m_bands)) {
+        for (const Span &span : band.spans) {
+            if (span.draggable != draggable) {
+                continue;
+            }
+            const QRect rect(span.left, band.top, span.right - span.left, band.bottom - band.top);
+            if (draggable) {
+                region.unite(rect);
+            } else {
+                region.subtract(rect);
+            }
+        }
+    }
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,106 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include "spanregion.h"
+#include <QtCore/qhash.h>
+#include <QtCore/qmap.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qvector.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    User defined drag regions and exclusion regions, each with a priority.
+
+    The regions are compiled into a flat, non-overlapping structure: a
+    sorted list of horizontal bands, each holding sorted spans that are
+    either draggable or excluded, decided by the region with the highest
+    priority (exclusion wins on a tie). A lookup is two binary searches.
+
+    Changing one region only recompiles the bands it covers, before and
+    after the change.
+ */
+class DragRegionMap
+{
+public:
+    enum class Hit : int
+    {
+        None = 0,
+        Draggable,
+        Excluded
+    };
+
+    int add(const QRect &rect, const bool draggable, const int priority);
+    bool update(const int id, const QRect &rect);
+    bool remove(const int id);
+    void clear();
+
+    bool isEmpty() const { return m_regions.isEmpty(); }
+
+    Hit hitTest(const QPoint &pos);
+    // Unite the draggable spans into region, or subtract the excluded ones.
+    void applyTo(SpanRegion &region, const bool draggable);
+
+private:
+    struct Region
+    {
+        QRect rect;
+        bool draggable = true;
+        int priority = 0;
+    };
+
+    struct Span
+    {
+        int left;
+        int right;
+        bool draggable;
+    };
+
+    struct Band
+    {
+        int top;
+        int bottom;
+        QVector<Span> spans;
+    };
+
+    void addEdges(const QRect &rect);
+    void removeEdges(const QRect &rect);
+    void markDirty(const QRect &rect);
+    void compile();
+    void compileBand(const int top, const int bottom, QVector<Band> &bands) const;
+
+    QHash<int, Region> m_regions;
+    int m_nextId = 1;
+    // Horizontal edges of all regions (bottom is exclusive), with a use count.
+    QMap<int, int> m_edges;
+    QVector<Band> m_bands;
+    bool m_dirty = false;
+    int m_dirtyTop = 0;
+    int m_dirtyBottom = 0;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,197 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "framelesseventhub.h"
+#include "framelesshelper.h"
+#include <QtCore/qcoreapplication.h>
+#include <QtGui/qevent.h>
+#include <QtGui/qwindow.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+Q_GLOBAL_STATIC(FramelessEventHub, g_framelessEventHub)
+
+FramelessEventHub::FramelessEventHub(QObject *parent) : QObject(parent) {}
+
+FramelessEventHub *FramelessEventHub::instance()
+{
+    return g_framelessEventHub();
+}
+
+void FramelessEventHub::addWindow(QWindow *window, FramelessHelper *helper)
+{
+    Q_ASSERT(window);
+    Q_ASSERT(helper);
+    if (!window || !helper) {
+        return;
+    }
+
+    m_lastSlot = nullptr;
+
+    if (Slot *slot = m_windows.find(window)) {
+        slot->helper = helper;
+        return;
+    }
+
+    Slot slot;
+    slot.object = window;
+    slot.helper = helper;
+    m_windows.insert(slot);
+    updateWindowState(window);
+    updateFilter();
+
+    // Both are half destroyed when this is called, only their address is used.
+    connect(window, &QObject::destroyed, this, &FramelessEventHub::removeSlot);
+    connect(helper, &QObject::destroyed, this, &FramelessEventHub::removeHelper, Qt::UniqueConnection);
+
+    const auto update = [this, window](){
+        updateWindowState(window);
+    };
+    connect(window, &QWindow::visibilityChanged, this, update);
+    connect(window, &QWindow::widthChanged, this, update);
+    connect(window, &QWindow::heightChanged, this, update);
+}
+
+void FramelessEventHub::removeWindow(QWindow *window)
+{
+    if (!window || !m_windows.find(window)) {
+        return;
+    }
+
+    disconnect(window, nullptr, this, nullptr);
+    removeSlot(window);
+}
+
+void FramelessEventHub::removeSlot(const QObject *window)
+{
+    m_lastSlot = nullptr;
+
+    m_windows.remove(window);
+    updateFilter();
+}
+
+/*!
+    Keep the application-wide filter installed only while there are windows
+    to route events to.
+ */
+void FramelessEventHub::updateFilter()
+{
+    QCoreApplication *app = QCoreApplication::instance();
+    const bool install = app && !m_windows.isEmpty();
+    if (install == m_filterInstalled) {
+        return;
+    }
+
+    if (install) {
+        app->installEventFilter(this);
+    } else if (app) {
+        app->removeEventFilter(this);
+    }
+    m_filterInstalled = install;
+}
+
+void FramelessEventHub::updateWindowState(QWindow *window)
+{
+    Slot *slot = m_windows.find(window);
+    if (!slot) {
+        return;
+    }
+
+    const QWindow::Visibility visibility = window->visibility();
+    slot->hidden = (visibility == QWindow::Hidden || visibility == QWindow::Minimized);
+    slot->size = window->size();
+}
+
+FramelessHelper *FramelessEventHub::helper(const QWindow *window) const
+{
+    const Slot *slot = m_windows.find(window);
+    return slot ? slot->helper : nullptr;
+}
+
+void FramelessEventHub::removeHelper(QObject *helper)
+{
+    m_lastSlot = nullptr;
+
+    m_windows.removeIf([helper](const Slot &slot) { return slot.helper == helper; });
+    updateFilter();
+}
+
+bool FramelessEventHub::shouldSkipHover(const Slot &slot, const QEvent *event) const
+{
+    if (slot.hidden) {
+        return true;
+    }
+
+    // Only moves delivered because of a mouse grab are outside of the window,
+    // without a pressed button they can't start a move or a resize.
+    const auto ev = static_cast<const QMouseEvent *>(event);
+    return !QRect(QPoint(0, 0), slot.size).contains(ev->pos());
+}
+
+bool FramelessEventHub::eventFilter(QObject *object, QEvent *event)
+{
+    // Every event of the application passes by here, only look up the
+    // window for the events FramelessHelper::handleWindowEvent() handles.
+    switch (event->type())
+    {
+    case QEvent::MouseMove:
+    case QEvent::NonClientAreaMouseMove:
+    case QEvent::MouseButtonPress:
+    case QEvent::NonClientAreaMouseButtonPress:
+    case QEvent::MouseButtonRelease:
+    case QEvent::NonClientAreaMouseButtonRelease:
+    case QEvent::MouseButtonDblClick:
+    case QEvent::NonClientAreaMouseButtonDblClick:
+    case QEvent::Leave:
+    case QEvent::Resize:
+    case QEvent::WindowStateChange:
+        break;
+    default:
+        return false;
+    }
+
+    if (!object->isWindowType()) {
+        return false;
+    }
+
+    if (!m_lastSlot || m_lastSlot->object != object) {
+        m_lastSlot = m_windows.find(object);
+        if (!m_lastSlot) {
+            return false;
+        }
+    }
+
+    if (event->type() == QEvent::MouseMove || event->type() == QEvent::NonClientAreaMouseMove) {
+        auto ev = static_cast<QMouseEvent *>(event);
+        if (ev->buttons() == Qt::NoButton && shouldSkipHover(*m_lastSlot, event)) {
+            ++m_skippedHovers;
+            return false;
+        }
+    }
+
+    return m_lastSlot->helper->handleWindowEvent(event);
+}
+
+FRAMELESSHELPER_END_NAMESPACE
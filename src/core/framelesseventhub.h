@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include "objectregistry.h"
+#include <QtCore/qobject.h>
+#include <QtCore/qsize.h>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QWindow)
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+class FramelessHelper;
+
+/*!
+    A single event filter, installed on the application, shared by all the
+    frameless windows. Events are rejected on their type and on the receiver
+    not being a window before any lookup; the slot of the window that got
+    the last event is remembered, so a burst of mouse moves is routed to its
+    FramelessHelper without hashing.
+
+    Each slot of the contiguous table holds what the dispatch reads for every
+    event: the helper, the window size and whether the window can be hovered
+    at all, kept up to date from the window's signals. The settings of the
+    windows (title bar height, resize border, profile) are not needed here,
+    they stay in WindowStateRegistry, which is keyed the same way.
+
+    Internal, not part of the library's API.
+ */
+class FramelessEventHub : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(FramelessEventHub)
+
+public:
+    explicit FramelessEventHub(QObject *parent = nullptr);
+    ~FramelessEventHub() override = default;
+
+    static FramelessEventHub *instance();
+
+    void addWindow(QWindow *window, FramelessHelper *helper);
+    void removeWindow(QWindow *window);
+
+    FramelessHelper *helper(const QWindow *window) const;
+    int windowCount() const { return m_windows.size(); }
+
+    quint64 skippedHoverCount() const { return m_skippedHovers; }
+
+protected:
+    bool eventFilter(QObject *object, QEvent *event) override;
+
+private:
+    struct Slot
+    {
+        QObject *object = nullptr; // The window
+        FramelessHelper *helper = nullptr;
+        QSize size;
+        // Hidden or minimized.
+        bool hidden = true;
+    };
+
+    bool shouldSkipHover(const Slot &slot, const QEvent *event) const;
+    void removeHelper(QObject *helper);
+    void removeSlot(const QObject *window);
+    void updateFilter();
+    void updateWindowState(QWindow *window);
+
+    ObjectRegistry<Slot> m_windows;
+    // Reset whenever the table changes, entries move around in it.
+    const Slot *m_lastSlot = nullptr;
+    bool m_filterInstalled = false;
+    quint64 m_skippedHovers = 0;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
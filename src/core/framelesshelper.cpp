@@ -23,9 +23,17 @@
  */
 
 #include "framelesshelper.h"
+#include "dragregionmap.h"
+#include "framezones.h"
+#include "hitmask.h"
+#include "hittestindex.h"
+#include "objectgeometry.h"
+#include "objectregistry.h"
+#include "spanregion.h"
 
 #include <QtCore/qdebug.h>
 #include <QtGui/qevent.h>
+#include <algorithm>
 #include <QtGui/qwindow.h>
 #include <QtGui/qscreen.h>
 #include <QtGui/qguiapplication.h>
@@ -36,6 +44,9 @@
 #endif
 
 #include "framelesswindowsmanager.h"
+#include "framelesseventhub.h"
+#include "windowsystembackend.h"
+#include "systemmetriccache.h"
 #include "utilities.h"
 #ifdef Q_OS_WIN
 #include "framelesshelper_windows.h"
@@ -45,6 +56,43 @@ FRAMELESSHELPER_BEGIN_NAMESPACE
 
 #define ENSURE_WINDOW(x) if (!m_window) return x
 
+/*!
+    The hit testing state of a FramelessHelper, kept out of its header so
+    the internal types it's made of don't become part of the API.
+ */
+struct FramelessHelperData
+{
+    /*!
+        A registered hit test visible object together with its cached
+        geometry. The cache is refreshed only after the object or one of
+        its ancestors reported a geometry or visibility change.
+     */
+    struct HTVObject
+    {
+        QObject *object = nullptr;
+        ObjectKind kind = ObjectKind::Unknown;
+        QRect rect;
+        bool visible = false;
+        bool dirty = true;
+        // Found by the title bar discovery rather than registered by the user.
+        bool discovered = false;
+    };
+
+    ObjectRegistry<HTVObject> HTVObjects;
+    // Only depends on the window size, the border thickness, the title bar
+    // height and the window state, rebuilt when one of those changes.
+    FrameZones frameZones;
+    HitMask hitMask;
+    DragRegionMap dragRegions;
+    // Scratch space of titleBarRegion() and nonClientRegion(), kept to
+    // reuse its buffers.
+    SpanRegion regionSpans;
+    HitTestIndex HTVIndex;
+    QVector<QRect> HTVRects;
+};
+
+using HTVObject = FramelessHelperData::HTVObject;
+
 FramelessHelper::FramelessHelper(QWindow *window)
     : QObject(window)
     , m_window(window)
@@ -52,6 +100,7 @@ FramelessHelper::FramelessHelper(QWindow *window)
     , m_clickedFrameSection(Qt::NoSection)
     , m_titleBarHeight(-1)
     , m_resizeBorderThickness(-1)
+    , d(new FramelessHelperData)
 {
 #ifdef Q_OS_MAC
     if(qEnvironmentVariable("QT_MAC_WANTS_LAYER") != QStringLiteral("1"))
@@ -59,6 +108,8 @@ FramelessHelper::FramelessHelper(QWindow *window)
 #endif
 }
 
+FramelessHelper::~FramelessHelper() = default;
+
 void FramelessHelper::setWindow(QWindow *w)
 {
     if (m_window == w)
@@ -67,6 +118,7 @@ void FramelessHelper::setWindow(QWindow *w)
     Q_ASSERT(w != nullptr && w->isTopLevel());
 
     m_window = w;
+    invalidateFrameZones();
 }
 
 /*!
@@ -100,9 +152,16 @@ void FramelessHelper::install()
     resizeWindow(origRect.size());
 
 #ifndef Q_OS_WIN
-    m_window->installEventFilter(this);
+    FramelessEventHub::instance()->addWindow(m_window, this);
 #endif
 
+    // The system metrics are DPI dependent.
+    connect(m_window, &QWindow::screenChanged, this, &FramelessHelper::invalidateFrameZones);
+    // So are the frame zones, e.g. after a DPI or an XSETTINGS change.
+    if (SystemMetricNotifier *notifier = SystemMetricCache::notifier()) {
+        connect(notifier, &SystemMetricNotifier::invalidated, this, &FramelessHelper::invalidateFrameZones);
+    }
+
 #ifdef Q_OS_MAC
     Utilities::setMacWindowHook(m_window);
     Utilities::setMacWindowFrameless(m_window);
@@ -128,9 +187,14 @@ void FramelessHelper::uninstall()
     resizeWindow(QSize());
 
 #ifndef Q_OS_WIN
-    m_window->removeEventFilter(this);
+    FramelessEventHub::instance()->removeWindow(m_window);
 #endif
 
+    disconnect(m_window, &QWindow::screenChanged, this, &FramelessHelper::invalidateFrameZones);
+    if (SystemMetricNotifier *notifier = SystemMetricCache::notifier()) {
+        disconnect(notifier, &SystemMetricNotifier::invalidated, this, &FramelessHelper::invalidateFrameZones);
+    }
+
 #ifdef Q_OS_MAC
     Utilities::unsetMacWindowHook(m_window);
     Utilities::unsetMacWindowFrameless(m_window);
@@ -144,6 +208,46 @@ void FramelessHelper::uninstall()
 #endif // Q_OS_WIN
 }
 
+/*!
+    Forget the window and everything set up for it, so the helper can be
+    used for another window. Call uninstall() first if the window is still
+    alive, the window itself is not touched here.
+ */
+void FramelessHelper::reset()
+{
+    setHitTestVisibleDiscoveryRoot(nullptr);
+    d->HTVObjects.clear();
+    updateHTVTracking();
+    invalidateHTVIndex();
+    clearDragRegions();
+    clearHitTestMask();
+
+    // uninstall() can't run once the window is gone.
+    if (SystemMetricNotifier *notifier = SystemMetricCache::notifier()) {
+        disconnect(notifier, &SystemMetricNotifier::invalidated, this, &FramelessHelper::invalidateFrameZones);
+    }
+
+    // Everything else back to what the constructor sets, nothing of the
+    // previous window may leak into the next one.
+    m_window = nullptr;
+    m_windowSize = QSize();
+    m_titleBarHeight = -1;
+    m_resizeBorderThickness = -1;
+    m_resizable = true;
+    m_origWindowFlags = Qt::WindowFlags();
+    m_cursorChanged = false;
+    m_cursorSection = Qt::NoSection;
+    m_hoveredFrameSection = Qt::NoSection;
+    m_clickedFrameSection = Qt::NoSection;
+    d->HTVRects.clear();
+    m_discoveryScheduled = false;
+    m_mouseMoveCoalescing = false;
+    m_mouseMovePending = false;
+    m_pendingMousePos = QPoint();
+    resetMouseMoveCounters();
+    invalidateFrameZones();
+}
+
 /*!
     Resize non-client area
  */
@@ -160,7 +264,7 @@ int FramelessHelper::titleBarHeight()
     ENSURE_WINDOW(0);
 
     if (m_titleBarHeight == -1) {
-        return Utilities::getSystemMetric(m_window, SystemMetric::TitleBarHeight, true, false);
+        return SystemMetricCache::getSystemMetric(m_window, SystemMetric::TitleBarHeight, true, false);
     }
 
     return m_titleBarHeight;
@@ -174,6 +278,7 @@ void FramelessHelper::setTitleBarHeight(int height)
     }
 
     m_titleBarHeight = height;
+    invalidateFrameZones();
 }
 
 QRect FramelessHelper::titleBarRect()
@@ -184,21 +289,18 @@ QRect FramelessHelper::titleBarRect()
 
 QRegion FramelessHelper::titleBarRegion()
 {
-    QRegion region(titleBarRect());
-
-    for (const auto obj : m_HTVObjects) {
-        if (!obj || !(obj->isWidgetType() || obj->inherits("QQuickItem"))) {
-            continue;
-        }
+    d->regionSpans.setRect(titleBarRect());
 
-        if (!obj->property("visible").toBool()) {
-            continue;
-        }
-
-        region -= getHTVObjectRect(obj);
+    // The user defined regions override the title bar strip.
+    if (!d->dragRegions.isEmpty()) {
+        d->dragRegions.applyTo(d->regionSpans, false);
+        d->dragRegions.applyTo(d->regionSpans, true);
+        d->regionSpans.intersect(QRect(QPoint(0, 0), windowSize()));
     }
 
-    return region;
+    subtractHTVObjects(d->regionSpans);
+
+    return d->regionSpans.toRegion();
 }
 
 int FramelessHelper::resizeBorderThickness()
@@ -206,7 +308,7 @@ int FramelessHelper::resizeBorderThickness()
     ENSURE_WINDOW(0);
 
     if (m_resizeBorderThickness == -1) {
-        return Utilities::getSystemMetric(m_window, SystemMetric::ResizeBorderThickness, true, false);
+        return SystemMetricCache::getSystemMetric(m_window, SystemMetric::ResizeBorderThickness, true, false);
     }
 
     return m_resizeBorderThickness;
@@ -220,6 +322,7 @@ void FramelessHelper::setResizeBorderThickness(int thickness)
     }
 
     m_resizeBorderThickness = thickness;
+    invalidateFrameZones();
 }
 
 QRect FramelessHelper::clientRect()
@@ -234,42 +337,505 @@ QRect FramelessHelper::clientRect()
 
 QRegion FramelessHelper::nonClientRegion()
 {
-    QRegion region(QRect(QPoint(0, 0), windowSize()));
-    region -= clientRect();
+    d->regionSpans.setRect(QRect(QPoint(0, 0), windowSize()));
+    d->regionSpans.subtract(clientRect());
 
-    for (const auto obj : m_HTVObjects) {
-        if (!obj || !(obj->isWidgetType() || obj->inherits("QQuickItem"))) {
-            continue;
+    if (!d->dragRegions.isEmpty()) {
+        d->dragRegions.applyTo(d->regionSpans, true);
+        d->regionSpans.intersect(QRect(QPoint(0, 0), windowSize()));
+    }
+
+    subtractHTVObjects(d->regionSpans);
+
+    return d->regionSpans.toRegion();
+}
+
+/*!
+    Remove the visible hit test visible objects from \a region.
+ */
+void FramelessHelper::subtractHTVObjects(SpanRegion &region)
+{
+    if (m_HTVIndexDirty) {
+        updateHTVIndex();
+    }
+
+    region.subtract(d->HTVRects.constData(), d->HTVRects.size());
+}
+
+/*!
+    Make \a rect, in window coordinates, drag the window like the title bar
+    does. Where regions overlap, the one with the highest \a priority wins.
+    User defined regions always win over the default title bar strip, the
+    hit test visible objects always win over everything.
+
+    Returns an id for updateDragRegion() and removeDragRegion().
+ */
+int FramelessHelper::addDragRegion(const QRect &rect, int priority)
+{
+    return d->dragRegions.add(rect, true, priority);
+}
+
+/*!
+    Prevent \a rect, in window coordinates, from dragging the window, even
+    if it's inside the title bar or a drag region with a lower \a priority.
+ */
+int FramelessHelper::addDragExclusionRegion(const QRect &rect, int priority)
+{
+    return d->dragRegions.add(rect, false, priority);
+}
+
+bool FramelessHelper::updateDragRegion(int id, const QRect &rect)
+{
+    return d->dragRegions.update(id, rect);
+}
+
+bool FramelessHelper::removeDragRegion(int id)
+{
+    return d->dragRegions.remove(id);
+}
+
+void FramelessHelper::clearDragRegions()
+{
+    d->dragRegions.clear();
+}
+
+/*!
+    Restrict hit testing to \a path, given in window coordinates. Points
+    outside of it, such as the transparent corners of a rounded window,
+    are never treated as resize handlers or title bar.
+ */
+void FramelessHelper::setHitTestMask(const QPainterPath &path)
+{
+    d->hitMask.setPath(path);
+}
+
+/*!
+    Restrict hit testing to the pixels of \a image which are not fully
+    transparent. The image is stretched to the window size if needed.
+ */
+void FramelessHelper::setHitTestMask(const QImage &image)
+{
+    d->hitMask.setImage(image);
+}
+
+/*!
+    Restrict hit testing to a rounded rectangle covering the whole window,
+    which follows the window when it's resized.
+ */
+void FramelessHelper::setHitTestMaskCornerRadius(qreal radius)
+{
+    d->hitMask.setCornerRadius(radius);
+}
+
+void FramelessHelper::clearHitTestMask()
+{
+    d->hitMask.clear();
+}
+
+bool FramelessHelper::isInHitTestMask(const QPoint &pos)
+{
+    if (d->hitMask.isNull()) {
+        return true;
+    }
+
+    // Rasterize lazily, the window may be resized many times in a row.
+    if (d->hitMask.size() != windowSize()) {
+        d->hitMask.rebuild(windowSize());
+    }
+
+    return d->hitMask.contains(pos);
+}
+
+bool FramelessHelper::isInTitlebarArea(const QPoint& pos)
+{
+    if (m_frameZonesDirty) {
+        updateFrameZones();
+    }
+
+    // Cheap rejection before we look at the hit test visible objects.
+    if (pos.x() < 0 || pos.x() >= d->frameZones.width || pos.y() < 0
+            || pos.y() >= (d->dragRegions.isEmpty() ? d->frameZones.titleBarHeight : d->frameZones.height)) {
+        return false;
+    }
+
+    if (!isInHitTestMask(pos)) {
+        return false;
+    }
+
+    if (m_HTVIndexDirty) {
+        updateHTVIndex();
+    }
+
+    if (d->HTVIndex.contains(pos)) {
+        return false;
+    }
+
+    if (!d->dragRegions.isEmpty()) {
+        switch (d->dragRegions.hitTest(pos)) {
+        case DragRegionMap::Hit::Draggable:
+            return true;
+        case DragRegionMap::Hit::Excluded:
+            return false;
+        case DragRegionMap::Hit::None:
+            break;
+        }
+    }
+
+    return pos.y() < d->frameZones.titleBarHeight;
+}
+
+void FramelessHelper::updateHTVIndex()
+{
+    m_HTVIndexDirty = false;
+
+    d->HTVRects.clear();
+    d->HTVRects.reserve(d->HTVObjects.size());
+
+    for (HTVObject &entry : d->HTVObjects) {
+        if (entry.dirty) {
+            entry.dirty = false;
+
+            entry.visible = (entry.kind != ObjectKind::Unknown)
+                    && ObjectGeometry::isVisible(entry.object, entry.kind);
+            entry.rect = entry.visible ? ObjectGeometry::windowRect(entry.object, entry.kind) : QRect();
         }
 
-        if (!obj->property("visible").toBool()) {
+        if (entry.visible) {
+            d->HTVRects.append(entry.rect);
+        }
+    }
+
+    // Sorted once here, the frame regions subtract them in a single sweep.
+    std::sort(d->HTVRects.begin(), d->HTVRects.end(), [](const QRect &lhs, const QRect &rhs) {
+        return lhs.y() < rhs.y();
+    });
+    d->HTVIndex.build(d->HTVRects);
+}
+
+/*!
+    Watch the hit test visible objects and all of their ancestors below the
+    top-level window, any of them moving, resizing, showing or hiding changes
+    the window-relative rectangle of the object.
+ */
+void FramelessHelper::updateHTVTracking()
+{
+    QHash<QObject*, ObjectKind> tracked;
+
+    for (const HTVObject &entry : qAsConst(d->HTVObjects)) {
+        if (entry.kind == ObjectKind::Unknown) {
             continue;
         }
 
-        region -= getHTVObjectRect(obj);
+        QObject *obj = entry.object;
+        tracked.insert(obj, entry.kind);
+        // The visual ancestors below the top level, which the rectangle is
+        // relative to. A QQuickItem's QObject parent can be anything.
+        for (QObject *p = ObjectGeometry::parentObject(obj, entry.kind);
+             p && ObjectGeometry::parentObject(p, entry.kind);
+             p = ObjectGeometry::parentObject(p, entry.kind)) {
+            tracked.insert(p, entry.kind);
+        }
+    }
+
+    for (auto it = m_HTVTrackedObjects.cbegin(); it != m_HTVTrackedObjects.cend(); ++it) {
+        if (!tracked.contains(it.key())) {
+            untrackHTVObject(it.key(), it.value());
+        }
+    }
+
+    for (auto it = tracked.cbegin(); it != tracked.cend(); ++it) {
+        if (!m_HTVTrackedObjects.contains(it.key())) {
+            trackHTVObject(it.key(), it.value());
+        }
     }
 
-    return region;
+    m_HTVTrackedObjects = tracked;
 }
 
-bool FramelessHelper::isInTitlebarArea(const QPoint& pos)
+void FramelessHelper::trackHTVObject(QObject *obj, ObjectKind kind)
 {
-    return titleBarRegion().contains(pos);
+    connect(obj, &QObject::destroyed, this, &FramelessHelper::handleHTVObjectDestroyed);
+
+    if (kind == ObjectKind::Widget) {
+        obj->installEventFilter(this);
+        return;
+    }
+
+    // QQuickItem doesn't receive events for geometry changes.
+    ObjectGeometry::watchGeometry(obj, kind, this, "handleHTVObjectChanged()", "handleHTVHierarchyChanged()");
 }
 
-/*! This variable is used to enlarge the corner resize handler area. */
-static const int kCornerFactor = 2;
+void FramelessHelper::untrackHTVObject(QObject *obj, ObjectKind kind)
+{
+    // Keep the connections of the title bar discovery.
+    disconnect(obj, &QObject::destroyed, this, &FramelessHelper::handleHTVObjectDestroyed);
+
+    if (kind == ObjectKind::Widget) {
+        if (!m_discoveryObjects.contains(obj)) {
+            obj->removeEventFilter(this);
+        }
+        return;
+    }
+
+    disconnect(obj, nullptr, this, SLOT(handleHTVObjectChanged()));
+    disconnect(obj, nullptr, this, SLOT(handleHTVHierarchyChanged()));
+}
+
+void FramelessHelper::markHTVObjectDirty(QObject *obj)
+{
+    if (HTVObject *entry = d->HTVObjects.find(obj)) {
+        entry->dirty = true;
+    } else {
+        // One of the ancestors changed, it's rare enough to refresh everything.
+        for (HTVObject &entry : d->HTVObjects) {
+            entry.dirty = true;
+        }
+    }
+
+    invalidateHTVIndex();
+}
+
+void FramelessHelper::handleHTVObjectChanged()
+{
+    markHTVObjectDirty(sender());
+}
+
+void FramelessHelper::handleHTVHierarchyChanged()
+{
+    updateHTVTracking();
+
+    for (HTVObject &entry : d->HTVObjects) {
+        entry.dirty = true;
+    }
+
+    invalidateHTVIndex();
+}
+
+void FramelessHelper::handleHTVObjectDestroyed(QObject *obj)
+{
+    // The object is half destroyed, only compare its address.
+    m_HTVTrackedObjects.remove(obj);
+
+    if (d->HTVObjects.remove(obj)) {
+        invalidateHTVIndex();
+    }
+}
 
 /*!
-    \brief Determine window frame section by coordinates.
+    Find the interactive objects inside \a titleBar and make them hit test
+    visible, so they don't have to be registered one by one. The subtree is
+    scanned once, after that only the children added to or removed from it
+    are looked at. An interactive object is registered as a whole, its own
+    children are not scanned.
+
+    Pass \c nullptr to stop the discovery, the objects registered by
+    setHitTestVisible() are kept in any case.
+ */
+void FramelessHelper::setHitTestVisibleDiscoveryRoot(QObject *titleBar)
+{
+    if (m_discoveryRoot == titleBar) {
+        return;
+    }
 
-    Returns the window frame section at position \a pos, or \c Qt::NoSection
-    if there is no window frame section at this position.
+    const QList<QObject*> watched = m_discoveryObjects.keys();
+    for (QObject *obj : watched) {
+        unwatchDiscoveryObject(obj);
+    }
+    m_discoveryQueue.clear();
+
+    d->HTVObjects.removeIf([](const HTVObject &entry) { return entry.discovered; });
+
+    m_discoveryRoot = titleBar;
+
+    if (m_discoveryRoot) {
+        const ObjectKind kind = ObjectGeometry::kindOf(m_discoveryRoot);
+        if (kind == ObjectKind::Unknown) {
+            qWarning() << m_discoveryRoot << "is not a QWidget or a QQuickItem.";
+            m_discoveryRoot = nullptr;
+        } else {
+            discoverHTVObjects(m_discoveryRoot, kind);
+        }
+    }
+
+    updateHTVTracking();
+    invalidateHTVIndex();
+}
 
+/*!
+    Register \a obj if it's interactive, otherwise watch it and walk down its
+    children. The caller updates the tracking and the index afterwards.
  */
-Qt::WindowFrameSection FramelessHelper::mapPosToFrameSection(const QPoint& pos)
+void FramelessHelper::discoverHTVObjects(QObject *obj, ObjectKind kind)
 {
-    ENSURE_WINDOW(Qt::NoSection);
+    if (kind == ObjectKind::Unknown || m_discoveryObjects.contains(obj) || isHitTestVisible(obj)) {
+        return;
+    }
+
+    if (obj != m_discoveryRoot && ObjectGeometry::isInteractive(obj, kind)) {
+        HTVObject entry;
+        entry.object = obj;
+        entry.kind = kind;
+        entry.discovered = true;
+        d->HTVObjects.insert(entry);
+        return;
+    }
+
+    watchDiscoveryObject(obj, kind);
+
+    const QObjectList children = ObjectGeometry::childObjects(obj, kind);
+    for (QObject *child : children) {
+        discoverHTVObjects(child, ObjectGeometry::kindOf(child));
+    }
+}
+
+void FramelessHelper::watchDiscoveryObject(QObject *obj, ObjectKind kind)
+{
+    m_discoveryObjects.insert(obj, kind);
+    connect(obj, &QObject::destroyed, this, &FramelessHelper::handleDiscoveryObjectDestroyed);
+
+    if (kind == ObjectKind::Widget) {
+        // Children are reported with QEvent::ChildAdded and QEvent::ChildRemoved.
+        obj->installEventFilter(this);
+    } else {
+        connect(obj, SIGNAL(childrenChanged()), this, SLOT(handleDiscoveryChildrenChanged()));
+    }
+}
+
+void FramelessHelper::unwatchDiscoveryObject(QObject *obj)
+{
+    const ObjectKind kind = m_discoveryObjects.take(obj);
+    disconnect(obj, &QObject::destroyed, this, &FramelessHelper::handleDiscoveryObjectDestroyed);
+
+    if (kind == ObjectKind::Widget) {
+        if (!m_HTVTrackedObjects.contains(obj)) {
+            obj->removeEventFilter(this);
+        }
+    } else {
+        disconnect(obj, SIGNAL(childrenChanged()), this, SLOT(handleDiscoveryChildrenChanged()));
+    }
+}
+
+bool FramelessHelper::isInDiscoveryTree(QObject *obj, ObjectKind kind)
+{
+    if (!m_discoveryRoot) {
+        return false;
+    }
+
+    for (QObject *p = obj; p; p = ObjectGeometry::parentObject(p, kind)) {
+        if (p == m_discoveryRoot) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+    Forget the discovered objects which have been moved out of the title bar.
+    Destroyed ones are already gone, so every pointer here is still valid.
+ */
+bool FramelessHelper::pruneDiscoveredObjects()
+{
+    const bool changed = d->HTVObjects.removeIf([this](const HTVObject &entry) {
+        return entry.discovered && !isInDiscoveryTree(entry.object, entry.kind);
+    }) > 0;
+
+    const QList<QObject*> watched = m_discoveryObjects.keys();
+    for (QObject *obj : watched) {
+        if (!isInDiscoveryTree(obj, m_discoveryObjects.value(obj))) {
+            unwatchDiscoveryObject(obj);
+        }
+    }
+
+    return changed;
+}
+
+/*!
+    Children are announced before they are fully constructed, so they are
+    classified later, once per event loop iteration. Passing \c nullptr only
+    schedules a pruning pass.
+ */
+void FramelessHelper::scheduleDiscovery(QObject *obj)
+{
+    if (obj) {
+        m_discoveryQueue.append(obj);
+    }
+
+    if (!m_discoveryScheduled) {
+        m_discoveryScheduled = true;
+        QMetaObject::invokeMethod(this, "processDiscoveryQueue", Qt::QueuedConnection);
+    }
+}
+
+void FramelessHelper::processDiscoveryQueue()
+{
+    m_discoveryScheduled = false;
+
+    const QVector<QPointer<QObject>> queue = m_discoveryQueue;
+    m_discoveryQueue.clear();
+
+    if (!m_discoveryRoot) {
+        return;
+    }
+
+    bool changed = pruneDiscoveredObjects();
+
+    for (const QPointer<QObject> &obj : queue) {
+        if (!obj) {
+            continue;
+        }
+
+        const int count = d->HTVObjects.size();
+
+        if (m_discoveryObjects.contains(obj)) {
+            // A QQuickItem container, see which of its children are new.
+            const ObjectKind kind = m_discoveryObjects.value(obj);
+            const QObjectList children = ObjectGeometry::childObjects(obj, kind);
+            for (QObject *child : children) {
+                discoverHTVObjects(child, ObjectGeometry::kindOf(child));
+            }
+        } else {
+            const ObjectKind kind = ObjectGeometry::kindOf(obj);
+            if (isInDiscoveryTree(obj, kind)) {
+                discoverHTVObjects(obj, kind);
+            }
+        }
+
+        changed = changed || d->HTVObjects.size() != count;
+    }
+
+    if (changed) {
+        updateHTVTracking();
+        invalidateHTVIndex();
+    }
+}
+
+void FramelessHelper::handleDiscoveryChildrenChanged()
+{
+    scheduleDiscovery(sender());
+}
+
+void FramelessHelper::handleDiscoveryObjectDestroyed(QObject *obj)
+{
+    // The object is half destroyed, only compare its address.
+    m_discoveryObjects.remove(obj);
+
+    if (obj == m_discoveryRoot) {
+        setHitTestVisibleDiscoveryRoot(nullptr);
+    }
+}
+
+/*! This variable is used to enlarge the corner resize handler area. */
+static const int kCornerFactor = 2;
+
+void FramelessHelper::updateFrameZones()
+{
+    m_frameZonesDirty = false;
+    d->frameZones = FrameZones();
+
+    if (!m_window) {
+        return;
+    }
 
     int border = 0;
 
@@ -277,111 +843,125 @@ Qt::WindowFrameSection FramelessHelper::mapPosToFrameSection(const QPoint& pos)
 
 #ifndef Q_OS_MAC
     // TODO: get system default resize border
-    const int sysBorder = Utilities::getSystemMetric(m_window, SystemMetric::ResizeBorderThickness, false);
+    const int sysBorder = SystemMetricCache::getSystemMetric(m_window, SystemMetric::ResizeBorderThickness, false);
 
     Qt::WindowStates states = m_window->windowState();
     // Resizing is disabled when WindowMaximized or WindowFullScreen
-    if (!(states & Qt::WindowMaximized) && !(states & Qt::WindowFullScreen))
+    if (m_resizable && !(states & Qt::WindowMaximized) && !(states & Qt::WindowFullScreen))
     {
         border = resizeBorderThickness();
         border = qMin(border, sysBorder);
     }
 #endif // Q_OS_MAC
 
-    QRect windowRect(0, 0, windowSize().width(), windowSize().height());
+    border = qMax(border, 0);
+    // The corner is kCornerFactor times the size of the border
+    d->frameZones.update(windowSize().width(), windowSize().height(),
+                        border, border * kCornerFactor, titleBarHeight());
+}
 
-    if (windowRect.contains(pos))
-    {
-        QPoint mappedPos = pos - windowRect.topLeft();
+/*!
+    \brief Determine window frame section by coordinates.
+
+    Returns the window frame section at position \a pos, or \c Qt::NoSection
+    if there is no window frame section at this position.
+
+ */
+Qt::WindowFrameSection FramelessHelper::mapPosToFrameSection(const QPoint& pos)
+{
+    ENSURE_WINDOW(Qt::NoSection);
 
-        // The corner is kCornerFactor times the size of the border
-        if (QRect(0, 0, border * kCornerFactor, border * kCornerFactor).contains(mappedPos))
-            return Qt::TopLeftSection;
+    if (m_frameZonesDirty) {
+        updateFrameZones();
+    }
+
+    if (!isInHitTestMask(pos))
+        return Qt::NoSection;
 
-        if (QRect(border * kCornerFactor, 0, windowRect.width() - border * 2 * kCornerFactor, border).contains(mappedPos))
-            return Qt::TopSection;
+    const Qt::WindowFrameSection section = d->frameZones.classify(pos);
 
-        if (QRect(windowRect.width() - border * kCornerFactor, 0, border * kCornerFactor, border * kCornerFactor).contains(mappedPos))
-            return Qt::TopRightSection;
+    // Determining window frame secion is the highest priority,
+    // so the determination of the title bar area can be simpler.
+    if (section == Qt::TitleBarArea || (section == Qt::NoSection && !d->dragRegions.isEmpty()))
+        return isInTitlebarArea(pos) ? Qt::TitleBarArea : Qt::NoSection;
+
+    return section;
+}
+
+/*!
+    Classify \a count points at once, the result for \c{points[i]} is
+    written to \c{sections[i]}. This is equivalent to calling
+    mapPosToFrameSection() for each point, but the zone compares are
+    vectorized.
+ */
+void FramelessHelper::mapPosToFrameSections(const QPoint *points, Qt::WindowFrameSection *sections, int count)
+{
+    if (count <= 0) {
+        return;
+    }
 
-        if (QRect(windowRect.width() - border, border * kCornerFactor, border, windowRect.height() - border * 2 * kCornerFactor).contains(mappedPos))
-            return Qt::RightSection;
+    if (!m_window) {
+        std::fill(sections, sections + count, Qt::NoSection);
+        return;
+    }
 
-        if (QRect(windowRect.width() - border * kCornerFactor, windowRect.height() - border * kCornerFactor, border * kCornerFactor, border * kCornerFactor).contains(mappedPos))
-            return Qt::BottomRightSection;
+    if (m_frameZonesDirty) {
+        updateFrameZones();
+    }
 
-        if (QRect(border * kCornerFactor, windowRect.height() - border, windowRect.width() - border * 2 * kCornerFactor, border).contains(mappedPos))
-            return Qt::BottomSection;
+    if (m_HTVIndexDirty) {
+        updateHTVIndex();
+    }
 
-        if (QRect(0, windowRect.height() - border * kCornerFactor, border * kCornerFactor, border * kCornerFactor).contains(mappedPos))
-            return Qt::BottomLeftSection;
+    d->frameZones.classify(points, sections, count);
 
-        if (QRect(0, border * kCornerFactor, border, windowRect.height() - border * 2 * kCornerFactor).contains(mappedPos))
-            return Qt::LeftSection;
+    if (d->HTVIndex.isEmpty() && d->hitMask.isNull() && d->dragRegions.isEmpty()) {
+        return;
+    }
 
-        // Determining window frame secion is the highest priority,
-        // so the determination of the title bar area can be simpler.
-        if (isInTitlebarArea(pos))
-            return Qt::TitleBarArea;
+    for (int i = 0; i != count; ++i) {
+        const Qt::WindowFrameSection section = sections[i];
+        if (section == Qt::TitleBarArea || (section == Qt::NoSection && !d->dragRegions.isEmpty())) {
+            // The hit test visible objects and the drag regions reshape the title bar.
+            sections[i] = isInTitlebarArea(points[i]) ? Qt::TitleBarArea : Qt::NoSection;
+        } else if (section != Qt::NoSection && !isInHitTestMask(points[i])) {
+            sections[i] = Qt::NoSection;
+        }
     }
+}
+
+QVector<Qt::WindowFrameSection> FramelessHelper::mapPosToFrameSections(const QVector<QPoint> &points)
+{
+    QVector<Qt::WindowFrameSection> sections(points.size());
+    mapPosToFrameSections(points.constData(), sections.data(), points.size());
+    return sections;
+}
 
-    return Qt::NoSection;
+static bool isResizeSection(const Qt::WindowFrameSection section)
+{
+    return section == Qt::LeftSection ||
+        section == Qt::RightSection ||
+        section == Qt::TopSection ||
+        section == Qt::BottomSection ||
+        section == Qt::TopLeftSection ||
+        section == Qt::TopRightSection ||
+        section == Qt::BottomLeftSection ||
+        section == Qt::BottomRightSection;
 }
 
 bool FramelessHelper::isHoverResizeHandler()
 {
-    return m_hoveredFrameSection == Qt::LeftSection ||
-        m_hoveredFrameSection == Qt::RightSection ||
-        m_hoveredFrameSection == Qt::TopSection ||
-        m_hoveredFrameSection == Qt::BottomSection ||
-        m_hoveredFrameSection == Qt::TopLeftSection ||
-        m_hoveredFrameSection == Qt::TopRightSection ||
-        m_hoveredFrameSection == Qt::BottomLeftSection ||
-        m_hoveredFrameSection == Qt::BottomRightSection;
+    return isResizeSection(m_hoveredFrameSection);
 }
 
 bool FramelessHelper::isClickResizeHandler()
 {
-    return m_clickedFrameSection == Qt::LeftSection ||
-        m_clickedFrameSection == Qt::RightSection ||
-        m_clickedFrameSection == Qt::TopSection ||
-        m_clickedFrameSection == Qt::BottomSection ||
-        m_clickedFrameSection == Qt::TopLeftSection ||
-        m_clickedFrameSection == Qt::TopRightSection ||
-        m_clickedFrameSection == Qt::BottomLeftSection ||
-        m_clickedFrameSection == Qt::BottomRightSection;
+    return isResizeSection(m_clickedFrameSection);
 }
 
 QCursor FramelessHelper::cursorForFrameSection(Qt::WindowFrameSection frameSection)
 {
-    Qt::CursorShape cursor = Qt::ArrowCursor;
-
-    switch (frameSection)
-    {
-    case Qt::LeftSection:
-    case Qt::RightSection:
-        cursor = Qt::SizeHorCursor;
-        break;
-    case Qt::BottomSection:
-    case Qt::TopSection:
-        cursor = Qt::SizeVerCursor;
-        break;
-    case Qt::TopLeftSection:
-    case Qt::BottomRightSection:
-        cursor = Qt::SizeFDiagCursor;
-        break;
-    case Qt::TopRightSection:
-    case Qt::BottomLeftSection:
-        cursor = Qt::SizeBDiagCursor;
-        break;
-    case Qt::TitleBarArea:
-        cursor = Qt::ArrowCursor;
-        break;
-    default:
-        break;
-    }
-
-    return QCursor(cursor);
+    return QCursor(WindowSystemBackend::cursorShapeForFrameSection(frameSection));
 }
 
 void FramelessHelper::setCursor(const QCursor& cursor)
@@ -407,24 +987,23 @@ void FramelessHelper::updateCursor()
 {
     ENSURE_WINDOW((void)0);
 
-#ifdef Q_OS_LINUX
+    WindowSystemBackend *backend = WindowSystemBackend::instance();
+    if (!backend)
+        return;
+
     if (isHoverResizeHandler()) {
-        Utilities::setX11CursorShape(m_window,
-            Utilities::getX11CursorForFrameSection(m_hoveredFrameSection));
+        // Only talk to the window system when the cursor really changes.
+        if (m_cursorChanged && m_cursorSection == m_hoveredFrameSection)
+            return;
+        backend->setResizeCursor(m_window, m_hoveredFrameSection);
+        m_cursorSection = m_hoveredFrameSection;
         m_cursorChanged = true;
     } else {
         if (!m_cursorChanged)
             return;
-        Utilities::resetX1CursorShape(m_window);
+        backend->unsetResizeCursor(m_window);
         m_cursorChanged = false;
     }
-#else
-    if (isHoverResizeHandler()) {
-        setCursor(cursorForFrameSection(m_hoveredFrameSection));
-    } else {
-        unsetCursor();
-    }
-#endif
 }
 
 void FramelessHelper::updateMouse(const QPoint& pos)
@@ -438,47 +1017,136 @@ void FramelessHelper::updateHoverStates(const QPoint& pos)
     m_hoveredFrameSection = mapPosToFrameSection(pos);
 }
 
+/*!
+    Defer the hover state and cursor updates of mouse moves to once per
+    event loop iteration, with the last position. Moves while a button is
+    pressed are still handled right away, so dragging and resizing start
+    without delay.
+ */
+void FramelessHelper::setMouseMoveCoalescing(bool enabled)
+{
+    m_mouseMoveCoalescing = enabled;
+
+    if (!enabled) {
+        flushPendingMouseMove();
+    }
+}
+
+void FramelessHelper::resetMouseMoveCounters()
+{
+    m_coalescedMouseMoves = 0;
+    m_processedMouseMoves = 0;
+}
+
+void FramelessHelper::processMouseMove(const QPoint &pos)
+{
+    if (m_mouseMovePending) {
+        // Superseded by this one.
+        m_mouseMovePending = false;
+        ++m_coalescedMouseMoves;
+    }
+
+    ++m_processedMouseMoves;
+    updateMouse(pos);
+}
+
+void FramelessHelper::scheduleMouseMove(const QPoint &pos)
+{
+    m_pendingMousePos = pos;
+
+    if (m_mouseMovePending) {
+        ++m_coalescedMouseMoves;
+        return;
+    }
+
+    m_mouseMovePending = true;
+    QMetaObject::invokeMethod(this, "flushPendingMouseMove", Qt::QueuedConnection);
+}
+
+void FramelessHelper::flushPendingMouseMove()
+{
+    if (!m_mouseMovePending) {
+        return;
+    }
+
+    m_mouseMovePending = false;
+    ++m_processedMouseMoves;
+    updateMouse(m_pendingMousePos);
+}
+
 void FramelessHelper::startMove(const QPoint &globalPos)
 {
     ENSURE_WINDOW((void)0);
 
-#ifdef Q_OS_LINUX
     // On HiDPI screen, X11 ButtonRelease is likely to trigger
     // a QEvent::MouseMove, so we reset m_clickedFrameSection in advance.
     m_clickedFrameSection = Qt::NoSection;
-    Utilities::sendX11ButtonReleaseEvent(m_window, globalPos);
-    Utilities::startX11Moving(m_window, globalPos);
-#endif
 
-#ifdef Q_OS_MAC
-    Utilities::startMacDrag(m_window, globalPos);
-#endif
+    if (WindowSystemBackend *backend = WindowSystemBackend::instance())
+        backend->startMove(m_window, globalPos);
 }
 
 void FramelessHelper::startResize(const QPoint &globalPos, Qt::WindowFrameSection frameSection)
 {
     ENSURE_WINDOW((void)0);
 
-#ifdef Q_OS_LINUX
-    // On HiDPI screen, X11 ButtonRelease is likely to trigger
-    // a QEvent::MouseMove, so we reset m_clickedFrameSection in advance.
+    // See startMove().
     m_clickedFrameSection = Qt::NoSection;
-    Utilities::sendX11ButtonReleaseEvent(m_window, globalPos);
-    Utilities::startX11Resizing(m_window, globalPos, frameSection);
-#endif
 
-    // On MacOS, we use native resize handler. So, we do not need to implement
-    // any resize function.
+    if (WindowSystemBackend *backend = WindowSystemBackend::instance())
+        backend->startResize(m_window, globalPos, frameSection);
 }
 
-void FramelessHelper::setHitTestVisible(QObject *obj)
+/*!
+    Let the mouse events inside \a obj go to the object itself instead of
+    dragging the window. Registered objects are dropped automatically when
+    they are destroyed.
+ */
+void FramelessHelper::setHitTestVisible(QObject *obj, bool visible)
 {
-    m_HTVObjects.push_back(obj);
+    if (!obj) {
+        return;
+    }
+
+    if (!visible) {
+        if (d->HTVObjects.remove(obj)) {
+            updateHTVTracking();
+            invalidateHTVIndex();
+        }
+        return;
+    }
+
+    if (HTVObject *entry = d->HTVObjects.find(obj)) {
+        // Keep it even if it leaves the discovered title bar.
+        entry->discovered = false;
+        return;
+    }
+
+    // Resolve the object type once, queries are dispatched on it later.
+    const ObjectKind kind = ObjectGeometry::kindOf(obj);
+    if (kind == ObjectKind::Unknown) {
+        // It could never be tracked, nor removed once it's destroyed.
+        qWarning() << obj << "is not a QWidget or a QQuickItem.";
+        return;
+    }
+
+    HTVObject entry;
+    entry.object = obj;
+    entry.kind = kind;
+    d->HTVObjects.insert(entry);
+
+    updateHTVTracking();
+    invalidateHTVIndex();
 }
 
 bool FramelessHelper::isHitTestVisible(QObject *obj)
 {
-    return m_HTVObjects.contains(obj);
+    return d->HTVObjects.contains(obj);
+}
+
+int FramelessHelper::hitTestVisibleObjectCount() const
+{
+    return d->HTVObjects.size();
 }
 
 /*!
@@ -490,126 +1158,170 @@ QRect FramelessHelper::getHTVObjectRect(QObject *obj)
         return {};
     }
 
-    if (!obj->isWidgetType() && !obj->inherits("QQuickItem")) {
+    const ObjectKind kind = ObjectGeometry::kindOf(obj);
+    if (kind == ObjectKind::Unknown) {
         qWarning() << obj << "is not a QWidget or a QQuickItem.";
         return {};
     }
 
-    // Get local position of descendant widget relative to top-level window,
-    QPointF localPos = {obj->property("x").toReal(), obj->property("y").toReal()};
-    for (QObject *p = obj->parent(); p; p = p->parent()) {
-        // If parent is nullptr, the QWidget is a window.
-        if (p->parent() == nullptr)
-            break;
-        // Top-level window of QQuickItem is a QWindow. 
-        if (p->isWindowType())
-            break;
-        localPos += {p->property("x").toReal(), p->property("y").toReal()};
+    return ObjectGeometry::windowRect(obj, kind);
+}
+
+bool FramelessHelper::eventFilter(QObject *object, QEvent *event)
+{
+    ENSURE_WINDOW(false);
+
+    if (object == m_window) {
+        return handleWindowEvent(event);
     }
 
-    const int width = obj->property("width").toInt();
-    const int height = obj->property("height").toInt();
+    // Hit test visible objects, their ancestors and the discovered title bar.
+    switch (event->type())
+    {
+    case QEvent::Move:
+    case QEvent::Resize:
+    case QEvent::Show:
+    case QEvent::Hide:
+        if (m_HTVTrackedObjects.contains(object))
+            markHTVObjectDirty(object);
+        break;
+    case QEvent::ParentChange:
+        if (m_HTVTrackedObjects.contains(object))
+            handleHTVHierarchyChanged();
+        break;
+    case QEvent::ChildAdded:
+        if (m_discoveryObjects.contains(object))
+            scheduleDiscovery(static_cast<QChildEvent *>(event)->child());
+        break;
+    case QEvent::ChildRemoved:
+        if (m_discoveryObjects.contains(object))
+            scheduleDiscovery(nullptr);
+        break;
+    default:
+        break;
+    }
 
-    return QRect(localPos.toPoint(), QSize(width, height));
+    return false;
 }
 
-bool FramelessHelper::eventFilter(QObject *object, QEvent *event)
+/*!
+    Handle an event of the window itself, usually dispatched by the
+    FramelessEventHub. Returns \c true to filter the event out.
+ */
+bool FramelessHelper::handleWindowEvent(QEvent *event)
 {
     ENSURE_WINDOW(false);
 
     bool filterOut = false;
 
-    if (object == m_window) {
-        switch (event->type())
-        {
-        case QEvent::Resize:
-        {
-            QResizeEvent* re = static_cast<QResizeEvent *>(event);
-            resizeWindow(re->size());
-            break;
+    switch (event->type())
+    {
+    case QEvent::Resize:
+    {
+        QResizeEvent* re = static_cast<QResizeEvent *>(event);
+        resizeWindow(re->size());
+        break;
+    }
+    case QEvent::WindowStateChange:
+    {
+        invalidateFrameZones();
+        break;
+    }
+    case QEvent::NonClientAreaMouseMove:
+    case QEvent::MouseMove:
+    {
+        auto ev = static_cast<QMouseEvent *>(event);
+
+        // Without a pressed button only the hover state and the cursor
+        // depend on the position, and only the last one matters.
+        bool overResizeHandler = false;
+        if (m_mouseMoveCoalescing && m_clickedFrameSection == Qt::NoSection) {
+            scheduleMouseMove(ev->pos());
+            // The hover state is behind, what reaches the application
+            // still depends on where this very move is.
+            overResizeHandler = isResizeSection(mapPosToFrameSection(ev->pos()));
+        } else {
+            processMouseMove(ev->pos());
+            overResizeHandler = isHoverResizeHandler();
         }
-        case QEvent::NonClientAreaMouseMove:
-        case QEvent::MouseMove:
-        {
-            auto ev = static_cast<QMouseEvent *>(event);
-            updateMouse(ev->pos());
-
-            // Resize handler have highest priority, so we do not
-            // send event to Qt. It works like non-client region. 
-            if (isHoverResizeHandler())
-                filterOut = true;
-
-            if (m_clickedFrameSection == Qt::TitleBarArea
-                    && isInTitlebarArea(ev->pos())) {
-                // Start system move
-                startMove(ev->globalPos());
-                ev->accept();
-                filterOut = true;
-            } else if (isClickResizeHandler()) {
-                // Start system resize
-                //
-                // When mouse moves outside resize handler, m_hoveredFrameSection will be
-                // set to Qt::NoSection , so we use m_clickedFrameSection instead. This
-                // case also takes into account that the mouse moves outside the window
-                // boundary.
-                startResize(ev->globalPos(), m_clickedFrameSection);
-                ev->accept();
-                filterOut = true;
-            }
 
-            break;
-        }
-        case QEvent::Leave:
-        {
-            updateMouse(m_window->mapFromGlobal(QCursor::pos()));
-            break;
+        // Resize handler have highest priority, so we do not
+        // send event to Qt. It works like non-client region. 
+        if (overResizeHandler)
+            filterOut = true;
+
+        if (m_clickedFrameSection == Qt::TitleBarArea
+                && isInTitlebarArea(ev->pos())) {
+            // Start system move
+            startMove(ev->globalPos());
+            ev->accept();
+            filterOut = true;
+        } else if (isClickResizeHandler()) {
+            // Start system resize
+            //
+            // When mouse moves outside resize handler, m_hoveredFrameSection will be
+            // set to Qt::NoSection , so we use m_clickedFrameSection instead. This
+            // case also takes into account that the mouse moves outside the window
+            // boundary.
+            startResize(ev->globalPos(), m_clickedFrameSection);
+            ev->accept();
+            filterOut = true;
         }
-        case QEvent::NonClientAreaMouseButtonPress:
-        case QEvent::MouseButtonPress:
-        {
-            auto ev = static_cast<QMouseEvent *>(event);
 
-            if (ev->button() == Qt::LeftButton) 
-                m_clickedFrameSection = m_hoveredFrameSection;
+        break;
+    }
+    case QEvent::Leave:
+    {
+        processMouseMove(m_window->mapFromGlobal(QCursor::pos()));
+        break;
+    }
+    case QEvent::NonClientAreaMouseButtonPress:
+    case QEvent::MouseButtonPress:
+    {
+        auto ev = static_cast<QMouseEvent *>(event);
+        flushPendingMouseMove();
 
-            // Prevents buttons on the edge from being clicked
-            if (isHoverResizeHandler())
-                filterOut = true;
+        if (ev->button() == Qt::LeftButton) 
+            m_clickedFrameSection = m_hoveredFrameSection;
 
-            break;
-        }
+        // Prevents buttons on the edge from being clicked
+        if (isHoverResizeHandler())
+            filterOut = true;
 
-        case QEvent::NonClientAreaMouseButtonRelease:
-        case QEvent::MouseButtonRelease:
-        {
-            m_clickedFrameSection = Qt::NoSection;
-            break;
-        }
+        break;
+    }
 
-        case QEvent::NonClientAreaMouseButtonDblClick:
-        case QEvent::MouseButtonDblClick:
-        {
-            auto ev = static_cast<QMouseEvent *>(event);
-            if (isHoverResizeHandler() && ev->button() == Qt::LeftButton) {
-                // double click resize handler
-                handleResizeHandlerDblClicked();
-                filterOut = true;
-            } else if (isInTitlebarArea(ev->pos()) && ev->button() == Qt::LeftButton) {
-                Qt::WindowStates states = m_window->windowState();
-                if (states & Qt::WindowMaximized)
-                    m_window->showNormal();
-                else
-                    m_window->showMaximized();
-                
-                filterOut = true;
-            }
+    case QEvent::NonClientAreaMouseButtonRelease:
+    case QEvent::MouseButtonRelease:
+    {
+        m_clickedFrameSection = Qt::NoSection;
+        break;
+    }
 
-            break;
+    case QEvent::NonClientAreaMouseButtonDblClick:
+    case QEvent::MouseButtonDblClick:
+    {
+        auto ev = static_cast<QMouseEvent *>(event);
+        flushPendingMouseMove();
+        if (isHoverResizeHandler() && ev->button() == Qt::LeftButton) {
+            // double click resize handler
+            handleResizeHandlerDblClicked();
+            filterOut = true;
+        } else if (isInTitlebarArea(ev->pos()) && ev->button() == Qt::LeftButton) {
+            Qt::WindowStates states = m_window->windowState();
+            if (states & Qt::WindowMaximized)
+                m_window->showNormal();
+            else
+                m_window->showMaximized();
+            
+            filterOut = true;
         }
 
-        default:
-            break;
-        }
+        break;
+    }
+
+    default:
+        break;
     }
 
     return filterOut;
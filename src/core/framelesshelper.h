@@ -28,14 +28,28 @@
 
 #include <QtCore/qobject.h>
 #include <QtCore/qsize.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qpointer.h>
+#include <QtCore/qrect.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtCore/qvector.h>
 
 QT_BEGIN_NAMESPACE
 QT_FORWARD_DECLARE_CLASS(QWindow)
 QT_FORWARD_DECLARE_CLASS(QMouseEvent)
+QT_FORWARD_DECLARE_CLASS(QRegion)
+QT_FORWARD_DECLARE_CLASS(QPainterPath)
+QT_FORWARD_DECLARE_CLASS(QImage)
+QT_FORWARD_DECLARE_CLASS(QCursor)
 QT_END_NAMESPACE
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
+// Internal, defined in headers which are not installed.
+enum class ObjectKind : int;
+class SpanRegion;
+struct FramelessHelperData;
+
 class FRAMELESSHELPER_API FramelessHelper : public QObject
 {
     Q_OBJECT
@@ -43,16 +57,19 @@ class FRAMELESSHELPER_API FramelessHelper : public QObject
 
 public:
     explicit FramelessHelper(QWindow *window = nullptr);
-    ~FramelessHelper() override = default;
+    ~FramelessHelper() override;
 
     void install();
     void uninstall();
+    void reset();
+
+    bool handleWindowEvent(QEvent *event);
 
     void setWindow(QWindow *w);
     QWindow *window() { return m_window; }
 
     QSize windowSize() { return m_windowSize; }
-    void setWindowSize(const QSize& size) { m_windowSize = size; }
+    void setWindowSize(const QSize& size) { m_windowSize = size; invalidateFrameZones(); }
     void resizeWindow(const QSize& windowSize);
 
     int titleBarHeight();
@@ -64,13 +81,26 @@ public:
     void setResizeBorderThickness(int thickness);
 
     bool resizable() { return m_resizable; }
-    void setResizable(bool resizable) { m_resizable = resizable; }
+    void setResizable(bool resizable) { m_resizable = resizable; invalidateFrameZones(); }
 
     QRect clientRect();
     QRegion nonClientRegion();
 
+    int addDragRegion(const QRect &rect, int priority = 0);
+    int addDragExclusionRegion(const QRect &rect, int priority = 0);
+    bool updateDragRegion(int id, const QRect &rect);
+    bool removeDragRegion(int id);
+    void clearDragRegions();
+
+    void setHitTestMask(const QPainterPath &path);
+    void setHitTestMask(const QImage &image);
+    void setHitTestMaskCornerRadius(qreal radius);
+    void clearHitTestMask();
+
     bool isInTitlebarArea(const QPoint& pos);
     Qt::WindowFrameSection mapPosToFrameSection(const QPoint& pos);
+    void mapPosToFrameSections(const QPoint *points, Qt::WindowFrameSection *sections, int count);
+    QVector<Qt::WindowFrameSection> mapPosToFrameSections(const QVector<QPoint> &points);
 
     bool isHoverResizeHandler();
     bool isClickResizeHandler();
@@ -83,13 +113,23 @@ public:
     void updateMouse(const QPoint& pos);
     void updateHoverStates(const QPoint& pos);
 
+    void setMouseMoveCoalescing(bool enabled);
+    bool mouseMoveCoalescing() const { return m_mouseMoveCoalescing; }
+    quint64 coalescedMouseMoveCount() const { return m_coalescedMouseMoves; }
+    quint64 processedMouseMoveCount() const { return m_processedMouseMoves; }
+    void resetMouseMoveCounters();
+
     void startMove(const QPoint &globalPos);
     void startResize(const QPoint &globalPos, Qt::WindowFrameSection frameSection);
 
-    void setHitTestVisible(QObject *obj);
+    void setHitTestVisible(QObject *obj, bool visible = true);
     bool isHitTestVisible(QObject *obj);
+    int hitTestVisibleObjectCount() const;
     QRect getHTVObjectRect(QObject *obj);
 
+    void setHitTestVisibleDiscoveryRoot(QObject *titleBar);
+    QObject *hitTestVisibleDiscoveryRoot() { return m_discoveryRoot; }
+
 #ifdef Q_OS_WIN
 #if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
     bool handleNativeEvent(QWindow *window, const QByteArray &eventType, void *message, qintptr *result);
@@ -102,17 +142,61 @@ protected:
     bool eventFilter(QObject *object, QEvent *event) override;
     void handleResizeHandlerDblClicked();
 
+private Q_SLOTS:
+    void handleHTVObjectChanged();
+    void handleHTVHierarchyChanged();
+    void handleHTVObjectDestroyed(QObject *obj);
+    void handleDiscoveryChildrenChanged();
+    void handleDiscoveryObjectDestroyed(QObject *obj);
+    void processDiscoveryQueue();
+    void flushPendingMouseMove();
+
 private:
+    void invalidateFrameZones() { m_frameZonesDirty = true; }
+    void updateFrameZones();
+    void invalidateHTVIndex() { m_HTVIndexDirty = true; }
+    void updateHTVIndex();
+    bool isInHitTestMask(const QPoint &pos);
+    void subtractHTVObjects(SpanRegion &region);
+    void updateHTVTracking();
+    void trackHTVObject(QObject *obj, ObjectKind kind);
+    void untrackHTVObject(QObject *obj, ObjectKind kind);
+    void markHTVObjectDirty(QObject *obj);
+    void discoverHTVObjects(QObject *obj, ObjectKind kind);
+    void watchDiscoveryObject(QObject *obj, ObjectKind kind);
+    void unwatchDiscoveryObject(QObject *obj);
+    bool isInDiscoveryTree(QObject *obj, ObjectKind kind);
+    bool pruneDiscoveredObjects();
+    void scheduleDiscovery(QObject *obj);
+    void processMouseMove(const QPoint &pos);
+    void scheduleMouseMove(const QPoint &pos);
+
     QWindow *m_window;
     QSize m_windowSize;
     int m_titleBarHeight;
     int m_resizeBorderThickness;
-    bool m_resizable;
+    bool m_resizable = true;
     Qt::WindowFlags m_origWindowFlags;
-    bool m_cursorChanged;
+    bool m_cursorChanged = false;
+    Qt::WindowFrameSection m_cursorSection = Qt::NoSection;
     Qt::WindowFrameSection m_hoveredFrameSection;
     Qt::WindowFrameSection m_clickedFrameSection;
-    QList<QObject*> m_HTVObjects;
+    QHash<QObject*, ObjectKind> m_HTVTrackedObjects;
+    // The hit testing structures, see FramelessHelperData.
+    QScopedPointer<FramelessHelperData> d;
+    bool m_frameZonesDirty = true;
+    bool m_HTVIndexDirty = true;
+    // Non-interactive objects of the discovery subtree, watched for children
+    // being added or removed.
+    QObject *m_discoveryRoot = nullptr;
+    QHash<QObject*, ObjectKind> m_discoveryObjects;
+    QVector<QPointer<QObject>> m_discoveryQueue;
+    bool m_discoveryScheduled = false;
+    bool m_mouseMoveCoalescing = false;
+    bool m_mouseMovePending = false;
+    QPoint m_pendingMousePos;
+    quint64 m_coalescedMouseMoves = 0;
+    quint64 m_processedMouseMoves = 0;
 };
 
 FRAMELESSHELPER_END_NAMESPACE
@@ -28,6 +28,8 @@
 #include <QtCore/qcoreapplication.h>
 #include <QtGui/qwindow.h>
 #include "utilities.h"
+#include "systemmetriccache.h"
+#include "windowstateregistry.h"
 #include "framelesshelper_windows.h"
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
@@ -100,6 +102,8 @@ static inline void installHelper(QWindow *window, const bool enable)
     const WId winId = window->winId();
     Utilities::updateFrameMargins(winId, !enable);
     Utilities::triggerFrameChange(winId);
+    WindowStateRegistry::ensure(window)->frameless = enable;
+    // Compatibility with code reading the property directly.
     window->setProperty(Constants::kFramelessModeFlag, enable);
 }
 
@@ -149,8 +153,16 @@ bool FramelessHelperWin::nativeEventFilter(const QByteArray &eventType, void *me
         // Anyway, we should skip it in this case.
         return false;
     }
-    const QWindow *window = Utilities::findWindow(reinterpret_cast<WId>(msg->hwnd));
-    if (!window || !window->property(Constants::kFramelessModeFlag).toBool()) {
+    // Caption and border sizes change with the theme, the non-client
+    // metrics and the DPI.
+    if ((msg->message == WM_SETTINGCHANGE) || (msg->message == WM_DPICHANGED) || Utilities::isThemeChanged(msg)) {
+        SystemMetricCache::invalidate();
+    }
+    // Windows which were never made frameless are not in the index, so
+    // their messages are rejected right here.
+    const QWindow *window = WindowStateRegistry::findWindow(reinterpret_cast<WId>(msg->hwnd));
+    const WindowStateRegistry::State *state = WindowStateRegistry::find(window);
+    if (!state || !state->frameless) {
         return false;
     }
     switch (msg->message) {
@@ -241,7 +253,7 @@ bool FramelessHelperWin::nativeEventFilter(const QByteArray &eventType, void *me
             // then the window is clipped to the monitor so that the resize handle
             // do not appear because you don't need them (because you can't resize
             // a window when it's maximized unless you restore it).
-            const int resizeBorderThickness = Utilities::getSystemMetric(window, SystemMetric::ResizeBorderThickness, true);
+            const int resizeBorderThickness = SystemMetricCache::getSystemMetric(window, SystemMetric::ResizeBorderThickness, true);
             clientRect->top += resizeBorderThickness;
             clientRect->bottom -= resizeBorderThickness;
             clientRect->left += resizeBorderThickness;
@@ -497,8 +509,8 @@ bool FramelessHelperWin::nativeEventFilter(const QByteArray &eventType, void *me
             break;
         }
         const LONG windowWidth = clientRect.right;
-        const int resizeBorderThickness = Utilities::getSystemMetric(window, SystemMetric::ResizeBorderThickness, true);
-        const int titleBarHeight = Utilities::getSystemMetric(window, SystemMetric::TitleBarHeight, true);
+        const int resizeBorderThickness = SystemMetricCache::getSystemMetric(window, SystemMetric::ResizeBorderThickness, true);
+        const int titleBarHeight = SystemMetricCache::getSystemMetric(window, SystemMetric::TitleBarHeight, true);
         bool isTitleBar = false;
         if (IsMaximized(msg->hwnd) || (window->windowState() == Qt::WindowFullScreen)) {
             isTitleBar = (localMouse.y() >= 0) && (localMouse.y() <= titleBarHeight)
@@ -0,0 +1,109 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "framelessprofile.h"
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+class FramelessProfileData : public QSharedData
+{
+public:
+    QString name;
+    int titleBarHeight = 0;
+    int resizeBorderThickness = 0;
+    bool resizable = true;
+};
+
+Q_GLOBAL_STATIC_WITH_ARGS(QSharedDataPointer<FramelessProfileData>, g_defaultProfileData, (new FramelessProfileData))
+
+FramelessProfile::FramelessProfile()
+{
+    if (const QSharedDataPointer<FramelessProfileData> *data = g_defaultProfileData()) {
+        d = *data;
+    } else {
+        d = new FramelessProfileData;
+    }
+}
+
+FramelessProfile::FramelessProfile(const QString &name) : d(new FramelessProfileData)
+{
+    d->name = name;
+}
+
+FramelessProfile::FramelessProfile(const FramelessProfile &other) = default;
+
+FramelessProfile &FramelessProfile::operator=(const FramelessProfile &other) = default;
+
+FramelessProfile::~FramelessProfile() = default;
+
+QString FramelessProfile::name() const
+{
+    return d->name;
+}
+
+int FramelessProfile::titleBarHeight() const
+{
+    return d->titleBarHeight;
+}
+
+FramelessProfile FramelessProfile::withTitleBarHeight(const int value) const
+{
+    // Keep sharing the data if nothing changes.
+    FramelessProfile profile(*this);
+    if (d->titleBarHeight != value) {
+        // Detaches, this profile is left alone.
+        profile.d->titleBarHeight = value;
+    }
+    return profile;
+}
+
+int FramelessProfile::resizeBorderThickness() const
+{
+    return d->resizeBorderThickness;
+}
+
+FramelessProfile FramelessProfile::withResizeBorderThickness(const int value) const
+{
+    FramelessProfile profile(*this);
+    if (d->resizeBorderThickness != value) {
+        profile.d->resizeBorderThickness = value;
+    }
+    return profile;
+}
+
+bool FramelessProfile::resizable() const
+{
+    return d->resizable;
+}
+
+FramelessProfile FramelessProfile::withResizable(const bool value) const
+{
+    FramelessProfile profile(*this);
+    if (d->resizable != value) {
+        profile.d->resizable = value;
+    }
+    return profile;
+}
+
+FRAMELESSHELPER_END_NAMESPACE
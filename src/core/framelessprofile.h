@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qshareddata.h>
+#include <QtCore/qstring.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+class FramelessProfileData;
+
+/*!
+    The frame settings of a window: title bar height, resize border
+    thickness and resizability. The data of a profile never changes once
+    it's built, so windows configured alike can rely on pointing to the
+    same data. Overriding a setting with one of the with*() functions
+    produces a new profile, copying the data only if the value differs.
+
+    Profiles registered with FramelessWindowsManager::registerProfile() can
+    be looked up by name, and registering a new profile under the same name
+    moves every window still sharing the old one over at once.
+ */
+class FRAMELESSHELPER_API FramelessProfile
+{
+public:
+    // All default constructed profiles share the same data.
+    FramelessProfile();
+    explicit FramelessProfile(const QString &name);
+    FramelessProfile(const FramelessProfile &other);
+    FramelessProfile &operator=(const FramelessProfile &other);
+    ~FramelessProfile();
+
+    QString name() const;
+
+    // 0 for the default.
+    int titleBarHeight() const;
+    int resizeBorderThickness() const;
+    bool resizable() const;
+
+    Q_REQUIRED_RESULT FramelessProfile withTitleBarHeight(const int value) const;
+    Q_REQUIRED_RESULT FramelessProfile withResizeBorderThickness(const int value) const;
+    Q_REQUIRED_RESULT FramelessProfile withResizable(const bool value) const;
+
+    // Whether both point to the same data, i.e. one is a copy of the other,
+    // or was derived from it without changing anything.
+    bool isSharedWith(const FramelessProfile &other) const { return d == other.d; }
+
+private:
+    QSharedDataPointer<FramelessProfileData> d;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -26,20 +26,199 @@
 #include <QtCore/qdebug.h>
 #include <QtCore/qvariant.h>
 #include <QtCore/qcoreapplication.h>
+#include <QtCore/qhash.h>
 #include <QtGui/qwindow.h>
 #ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+#include <QtCore/qvector.h>
 #include "framelesshelper.h"
 #else
 #include <QtGui/qscreen.h>
 #include "framelesshelper_win32.h"
 #endif
 #include "utilities.h"
+#include "systemmetriccache.h"
+#include "objectgeometry.h"
+#include "hittestvisibleregistry.h"
+#include "windowstateregistry.h"
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
+struct FramelessProfileRegistry
+{
+    QHash<QString, FramelessProfile> profiles;
+};
+
+Q_GLOBAL_STATIC(FramelessProfileRegistry, g_framelessProfileRegistry)
+Q_GLOBAL_STATIC(FramelessWindowsNotifier, g_framelessWindowsNotifier)
+
+static void notifyWindowSettingsChanged(QWindow *window)
+{
+    if (FramelessWindowsNotifier *n = g_framelessWindowsNotifier()) {
+        Q_EMIT n->windowSettingsChanged(window);
+    }
+}
+
+static void applyProfile(QWindow *window, const FramelessProfile &previous);
+
+#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+// Idle helpers kept for reuse, transient windows come and go in bursts.
+static constexpr int kMaxIdleHelpers = 8;
+
+/*!
+    The FramelessHelper of each window added to the manager. Helpers of
+    removed or destroyed windows are reset and handed to the next window.
+ */
+struct FramelessHelperPool
+{
+    ~FramelessHelperPool()
+    {
+        qDeleteAll(live);
+        qDeleteAll(idle);
+    }
+
+    // Receiver of all the destroyed() connections, they go away with it.
+    QObject context;
+    QHash<const QWindow *, FramelessHelper *> live;
+    QVector<FramelessHelper *> idle;
+};
+
+Q_GLOBAL_STATIC(FramelessHelperPool, g_framelessHelperPool)
+
+static FramelessHelper *liveHelper(const QWindow *window)
+{
+    FramelessHelperPool *pool = g_framelessHelperPool();
+    return pool ? pool->live.value(window, nullptr) : nullptr;
+}
+
+static void recycleHelper(FramelessHelperPool *pool, FramelessHelper *helper)
+{
+    helper->reset();
+    if (pool->idle.size() < kMaxIdleHelpers) {
+        pool->idle.append(helper);
+    } else {
+        delete helper;
+    }
+}
+
+static void installHelper(QWindow *window)
+{
+    FramelessHelperPool *pool = g_framelessHelperPool();
+    if (!pool || pool->live.contains(window)) {
+        return;
+    }
+
+    FramelessHelper *helper = pool->idle.isEmpty() ? new FramelessHelper : pool->idle.takeLast();
+    helper->setWindow(window);
+    pool->live.insert(window, helper);
+
+    // Settings made before the window was added, the helper starts from the defaults.
+    if (const WindowStateRegistry::State *state = WindowStateRegistry::find(window)) {
+        const FramelessProfile &profile = state->profile;
+        // -1 makes the helper use the system metrics.
+        helper->setTitleBarHeight(profile.titleBarHeight() > 0 ? profile.titleBarHeight() : -1);
+        helper->setResizeBorderThickness(profile.resizeBorderThickness() > 0 ? profile.resizeBorderThickness() : -1);
+        helper->setResizable(profile.resizable());
+    }
+    if (const ObjectRegistry<HitTestVisibleRegistry::Entry> *objects = HitTestVisibleRegistry::objects(window)) {
+        for (const HitTestVisibleRegistry::Entry &entry : *objects) {
+            helper->setHitTestVisible(entry.object);
+        }
+    }
+
+    helper->install();
+
+    // The window is half destroyed, it can't be restored any more.
+    QObject::connect(window, &QObject::destroyed, &pool->context, [window](){
+        if (FramelessHelperPool *p = g_framelessHelperPool()) {
+            if (FramelessHelper *h = p->live.take(window)) {
+                recycleHelper(p, h);
+            }
+        }
+    });
+}
+
+static void uninstallHelper(QWindow *window)
+{
+    FramelessHelperPool *pool = g_framelessHelperPool();
+    if (!pool) {
+        return;
+    }
+    FramelessHelper *helper = pool->live.take(window);
+    if (!helper) {
+        return;
+    }
+    QObject::disconnect(window, &QObject::destroyed, &pool->context, nullptr);
+    helper->unsetCursor();
+    helper->uninstall();
+    recycleHelper(pool, helper);
+}
+#endif
+
+/*!
+    Push the settings of the window's profile which differ from \a previous
+    to the window and its helper, nothing else of the window is touched.
+ */
+static void applyProfile(QWindow *window, const FramelessProfile &previous)
+{
+    const WindowStateRegistry::State *state = WindowStateRegistry::find(window);
+    if (!state) {
+        return;
+    }
+    // A copy, the state may move while the window is changed.
+    const FramelessProfile profile = state->profile;
+#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+    FramelessHelper *helper = liveHelper(window);
+#endif
+
+    bool changed = false;
+
+    // The properties are kept for compatibility with code reading them directly.
+    if (profile.titleBarHeight() != previous.titleBarHeight()) {
+        changed = true;
+#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+        if (helper) {
+            // -1 makes the helper use the system metrics.
+            helper->setTitleBarHeight(profile.titleBarHeight() > 0 ? profile.titleBarHeight() : -1);
+        }
+#endif
+        window->setProperty(Constants::kTitleBarHeightFlag, profile.titleBarHeight());
+    }
+
+    if (profile.resizeBorderThickness() != previous.resizeBorderThickness()) {
+        changed = true;
 #ifdef FRAMELESSHELPER_USE_UNIX_VERSION
-//Q_GLOBAL_STATIC(FramelessHelper, framelessHelperUnix)
+        if (helper) {
+            helper->setResizeBorderThickness(profile.resizeBorderThickness() > 0 ? profile.resizeBorderThickness() : -1);
+        }
 #endif
+        window->setProperty(Constants::kResizeBorderThicknessFlag, profile.resizeBorderThickness());
+    }
+
+    if (profile.resizable() != previous.resizable()) {
+        changed = true;
+#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+        if (helper) {
+            helper->setResizable(profile.resizable());
+        }
+#else
+        if (!profile.resizable()) {
+            // Don't take over the hint if the application set it itself.
+            if (!window->flags().testFlag(Qt::MSWindowsFixedSizeDialogHint)) {
+                window->setFlag(Qt::MSWindowsFixedSizeDialogHint, true);
+                WindowStateRegistry::ensure(window)->fixedSizeHintSet = true;
+            }
+        } else if (WindowStateRegistry::ensure(window)->fixedSizeHintSet) {
+            window->setFlag(Qt::MSWindowsFixedSizeDialogHint, false);
+            WindowStateRegistry::ensure(window)->fixedSizeHintSet = false;
+        }
+#endif
+        window->setProperty(Constants::kWindowFixedSizeFlag, !profile.resizable());
+    }
+
+    if (changed) {
+        notifyWindowSettingsChanged(window);
+    }
+}
 
 void FramelessWindowsManager::addWindow(QWindow *window)
 {
@@ -51,8 +230,10 @@ void FramelessWindowsManager::addWindow(QWindow *window)
         QCoreApplication::setAttribute(Qt::AA_DontCreateNativeWidgetSiblings);
     }
 #ifdef FRAMELESSHELPER_USE_UNIX_VERSION
-    //framelessHelperUnix()->removeWindowFrame(window);
+    installHelper(window);
+    WindowStateRegistry::ensure(window)->frameless = true;
 #else
+    // Updates the window state as well.
     FramelessHelperWin::addFramelessWindow(window);
     // Work-around a Win32 multi-monitor bug.
     QObject::connect(window, &QWindow::screenChanged, [window](QScreen *screen){
@@ -60,6 +241,8 @@ void FramelessWindowsManager::addWindow(QWindow *window)
         window->resize(window->size());
     });
 #endif
+    // The defaults may differ for frameless windows.
+    notifyWindowSettingsChanged(window);
 }
 
 void FramelessWindowsManager::setHitTestVisible(QWindow *window, QObject *object, const bool value)
@@ -69,21 +252,30 @@ void FramelessWindowsManager::setHitTestVisible(QWindow *window, QObject *object
     if (!window || !object) {
         return;
     }
-    if (!object->isWidgetType() && !object->inherits("QQuickItem")) {
+    const ObjectKind kind = ObjectGeometry::kindOf(object);
+    if (kind == ObjectKind::Unknown) {
         qWarning() << object << "is not a QWidget or QQuickItem.";
         return;
     }
-    auto objList = qvariant_cast<QObjectList>(window->property(Constants::kHitTestVisibleFlag));
     if (value) {
-        if (objList.isEmpty() || !objList.contains(object)) {
-            objList.append(object);
-        }
+        HitTestVisibleRegistry::add(window, object, kind);
     } else {
-        if (!objList.isEmpty() && objList.contains(object)) {
-            objList.removeAll(object);
-        }
+        HitTestVisibleRegistry::remove(window, object);
     }
-    window->setProperty(Constants::kHitTestVisibleFlag, QVariant::fromValue(objList));
+#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
+    if (FramelessHelper *helper = liveHelper(window)) {
+        helper->setHitTestVisible(object, value);
+    }
+#endif
+}
+
+int FramelessWindowsManager::getHitTestVisibleObjectCount(const QWindow *window)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return 0;
+    }
+    return HitTestVisibleRegistry::size(window);
 }
 
 int FramelessWindowsManager::getResizeBorderThickness(const QWindow *window)
@@ -93,10 +285,13 @@ int FramelessWindowsManager::getResizeBorderThickness(const QWindow *window)
         return 8;
     }
 #ifdef FRAMELESSHELPER_USE_UNIX_VERSION
-    const int value = window->property(Constants::kResizeBorderThicknessFlag).toInt();
-    return value <= 0 ? 8 : value;
+    // Logical pixels, like the values the setter takes. The helper works
+    // with device pixels.
+    const WindowStateRegistry::State *state = WindowStateRegistry::find(window);
+    const int value = state ? state->profile.resizeBorderThickness() : 0;
+    return value > 0 ? value : SystemMetricCache::getSystemMetric(window, SystemMetric::ResizeBorderThickness, false);
 #else
-    return Utilities::getSystemMetric(window, SystemMetric::ResizeBorderThickness, false);
+    return SystemMetricCache::getSystemMetric(window, SystemMetric::ResizeBorderThickness, false);
 #endif
 }
 
@@ -106,7 +301,12 @@ void FramelessWindowsManager::setResizeBorderThickness(QWindow *window, const in
     if (!window || (value <= 0)) {
         return;
     }
-    window->setProperty(Constants::kResizeBorderThicknessFlag, value);
+    WindowStateRegistry::State *state = WindowStateRegistry::ensure(window);
+    const FramelessProfile previous = state->profile;
+    // A new value gives the window a profile of its own, the shared one
+    // is never changed.
+    state->profile = previous.withResizeBorderThickness(value);
+    applyProfile(window, previous);
 }
 
 int FramelessWindowsManager::getTitleBarHeight(const QWindow *window)
@@ -116,10 +316,11 @@ int FramelessWindowsManager::getTitleBarHeight(const QWindow *window)
         return 31;
     }
 #ifdef FRAMELESSHELPER_USE_UNIX_VERSION
-    const int value = window->property(Constants::kTitleBarHeightFlag).toInt();
-    return value <= 0 ? 31 : value;
+    const WindowStateRegistry::State *state = WindowStateRegistry::find(window);
+    const int value = state ? state->profile.titleBarHeight() : 0;
+    return value > 0 ? value : SystemMetricCache::getSystemMetric(window, SystemMetric::TitleBarHeight, false);
 #else
-    return Utilities::getSystemMetric(window, SystemMetric::TitleBarHeight, false);
+    return SystemMetricCache::getSystemMetric(window, SystemMetric::TitleBarHeight, false);
 #endif
 }
 
@@ -129,7 +330,10 @@ void FramelessWindowsManager::setTitleBarHeight(QWindow *window, const int value
     if (!window || (value <= 0)) {
         return;
     }
-    window->setProperty(Constants::kTitleBarHeightFlag, value);
+    WindowStateRegistry::State *state = WindowStateRegistry::ensure(window);
+    const FramelessProfile previous = state->profile;
+    state->profile = previous.withTitleBarHeight(value);
+    applyProfile(window, previous);
 }
 
 bool FramelessWindowsManager::getResizable(const QWindow *window)
@@ -139,7 +343,8 @@ bool FramelessWindowsManager::getResizable(const QWindow *window)
         return false;
     }
 #ifdef FRAMELESSHELPER_USE_UNIX_VERSION
-    return !window->property(Constants::kWindowFixedSizeFlag).toBool();
+    const WindowStateRegistry::State *state = WindowStateRegistry::find(window);
+    return !state || state->profile.resizable();
 #else
     return !Utilities::isWindowFixedSize(window);
 #endif
@@ -151,11 +356,10 @@ void FramelessWindowsManager::setResizable(QWindow *window, const bool value)
     if (!window) {
         return;
     }
-#ifdef FRAMELESSHELPER_USE_UNIX_VERSION
-    window->setProperty(Constants::kWindowFixedSizeFlag, !value);
-#else
-    window->setFlag(Qt::MSWindowsFixedSizeDialogHint, !value);
-#endif
+    WindowStateRegistry::State *state = WindowStateRegistry::ensure(window);
+    const FramelessProfile previous = state->profile;
+    state->profile = previous.withResizable(value);
+    applyProfile(window, previous);
 }
 
 void FramelessWindowsManager::removeWindow(QWindow *window)
@@ -165,10 +369,12 @@ void FramelessWindowsManager::removeWindow(QWindow *window)
         return;
     }
 #ifdef FRAMELESSHELPER_USE_UNIX_VERSION
-    //framelessHelperUnix()->bringBackWindowFrame(window);
+    uninstallHelper(window);
+    WindowStateRegistry::ensure(window)->frameless = false;
 #else
     FramelessHelperWin::removeFramelessWindow(window);
 #endif
+    notifyWindowSettingsChanged(window);
 }
 
 bool FramelessWindowsManager::isWindowFrameless(const QWindow *window)
@@ -177,7 +383,70 @@ bool FramelessWindowsManager::isWindowFrameless(const QWindow *window)
     if (!window) {
         return false;
     }
-    return window->property(Constants::kFramelessModeFlag).toBool();
+    const WindowStateRegistry::State *state = WindowStateRegistry::find(window);
+    return state && state->frameless;
+}
+
+void FramelessWindowsManager::registerProfile(const FramelessProfile &profile)
+{
+    FramelessProfileRegistry *registry = g_framelessProfileRegistry();
+    if (!registry) {
+        return;
+    }
+    if (profile.name().isEmpty()) {
+        qWarning() << "Profiles without a name can't be registered.";
+        return;
+    }
+    const auto it = registry->profiles.find(profile.name());
+    if (it == registry->profiles.end()) {
+        registry->profiles.insert(profile.name(), profile);
+        return;
+    }
+    if (it->isSharedWith(profile)) {
+        return;
+    }
+    // Windows which changed one of their settings have a copy of their own
+    // and keep it.
+    const QVector<QWindow *> windows = WindowStateRegistry::windowsSharing(it.value());
+    const FramelessProfile previous = it.value();
+    it.value() = profile;
+    for (QWindow *window : windows) {
+        WindowStateRegistry::ensure(window)->profile = profile;
+        applyProfile(window, previous);
+    }
+}
+
+FramelessProfile FramelessWindowsManager::findProfile(const QString &name)
+{
+    FramelessProfileRegistry *registry = g_framelessProfileRegistry();
+    return registry ? registry->profiles.value(name) : FramelessProfile();
+}
+
+void FramelessWindowsManager::setProfile(QWindow *window, const FramelessProfile &profile)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return;
+    }
+    WindowStateRegistry::State *state = WindowStateRegistry::ensure(window);
+    if (state->profile.isSharedWith(profile)) {
+        return;
+    }
+    const FramelessProfile previous = state->profile;
+    state->profile = profile;
+    applyProfile(window, previous);
+}
+
+FramelessProfile FramelessWindowsManager::getProfile(const QWindow *window)
+{
+    Q_ASSERT(window);
+    const WindowStateRegistry::State *state = WindowStateRegistry::find(window);
+    return state ? state->profile : FramelessProfile();
+}
+
+FramelessWindowsNotifier *FramelessWindowsManager::notifier()
+{
+    return g_framelessWindowsNotifier();
 }
 
 FRAMELESSHELPER_END_NAMESPACE
@@ -25,14 +25,32 @@
 #pragma once
 
 #include "framelesshelper_global.h"
+#include "framelessprofile.h"
+#include <QtCore/qobject.h>
 
 QT_BEGIN_NAMESPACE
-QT_FORWARD_DECLARE_CLASS(QObject)
 QT_FORWARD_DECLARE_CLASS(QWindow)
 QT_END_NAMESPACE
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
+/*!
+    Announces the changes of the per-window settings, whether they were set
+    on the window, came with a profile or are frameless-dependent.
+ */
+class FRAMELESSHELPER_API FramelessWindowsNotifier : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(FramelessWindowsNotifier)
+
+public:
+    explicit FramelessWindowsNotifier(QObject *parent = nullptr) : QObject(parent) {}
+    ~FramelessWindowsNotifier() override = default;
+
+Q_SIGNALS:
+    void windowSettingsChanged(QWindow *window);
+};
+
 namespace FramelessWindowsManager
 {
 
@@ -40,12 +58,19 @@ FRAMELESSHELPER_API void addWindow(QWindow *window);
 FRAMELESSHELPER_API void removeWindow(QWindow *window);
 FRAMELESSHELPER_API bool isWindowFrameless(const QWindow *window);
 FRAMELESSHELPER_API void setHitTestVisible(QWindow *window, QObject *object, const bool value = true);
+FRAMELESSHELPER_API int getHitTestVisibleObjectCount(const QWindow *window);
 FRAMELESSHELPER_API int getResizeBorderThickness(const QWindow *window);
 FRAMELESSHELPER_API void setResizeBorderThickness(QWindow *window, const int value);
 FRAMELESSHELPER_API int getTitleBarHeight(const QWindow *window);
 FRAMELESSHELPER_API void setTitleBarHeight(QWindow *window, const int value);
 FRAMELESSHELPER_API bool getResizable(const QWindow *window);
 FRAMELESSHELPER_API void setResizable(QWindow *window, const bool value = true);
+FRAMELESSHELPER_API void registerProfile(const FramelessProfile &profile);
+FRAMELESSHELPER_API FramelessProfile findProfile(const QString &name);
+FRAMELESSHELPER_API void setProfile(QWindow *window, const FramelessProfile &profile);
+FRAMELESSHELPER_API FramelessProfile getProfile(const QWindow *window);
+// nullptr at shutdown.
+FRAMELESSHELPER_API FramelessWindowsNotifier *notifier();
 
 }
 
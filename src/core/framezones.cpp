@@ -0,0 +1,189 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "framezones.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define FRAMELESSHELPER_FRAMEZONES_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FRAMELESSHELPER_FRAMEZONES_NEON
+#include <arm_neon.h>
+#endif
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// Same order as the zones, the first match wins.
+static const Qt::WindowFrameSection kZoneSections[FrameZones::ZoneCount] = {
+    Qt::TopLeftSection,
+    Qt::TopSection,
+    Qt::TopRightSection,
+    Qt::RightSection,
+    Qt::BottomRightSection,
+    Qt::BottomSection,
+    Qt::BottomLeftSection,
+    Qt::LeftSection
+};
+
+void FrameZones::update(const int windowWidth, const int windowHeight, const int borderThickness,
+                        const int cornerSize, const int titleBarHeightValue)
+{
+    width = windowWidth;
+    height = windowHeight;
+    border = borderThickness;
+    corner = cornerSize;
+    titleBarHeight = titleBarHeightValue;
+
+    const int w = width;
+    const int h = height;
+    const int b = border;
+    const int c = corner;
+
+    const auto setZone = [this, b](const int index, const int l, const int t, const int r, const int btm) {
+        left[index] = l;
+        top[index] = t;
+        // Empty zones never match.
+        right[index] = (b > 0) ? r : l;
+        bottom[index] = btm;
+    };
+
+    setZone(0, 0, 0, c, c);             // TopLeft
+    setZone(1, c, 0, w - c, b);         // Top
+    setZone(2, w - c, 0, w, c);         // TopRight
+    setZone(3, w - b, c, w, h - c);     // Right
+    setZone(4, w - c, h - c, w, h);     // BottomRight
+    setZone(5, c, h - b, w - c, h);     // Bottom
+    setZone(6, 0, h - c, c, h);         // BottomLeft
+    setZone(7, 0, c, b, h - c);         // Left
+}
+
+Qt::WindowFrameSection FrameZones::classify(const QPoint &pos) const
+{
+    const int x = pos.x();
+    const int y = pos.y();
+
+    if (x < 0 || y < 0 || x >= width || y >= height) {
+        return Qt::NoSection;
+    }
+
+    for (int i = 0; i != ZoneCount; ++i) {
+        if (x >= left[i] && x < right[i] && y >= top[i] && y < bottom[i]) {
+            return kZoneSections[i];
+        }
+    }
+
+    return (y < titleBarHeight) ? Qt::TitleBarArea : Qt::NoSection;
+}
+
+void FrameZones::classify(const QPoint *points, Qt::WindowFrameSection *sections, const int count) const
+{
+    int i = 0;
+
+#if defined(FRAMELESSHELPER_FRAMEZONES_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w = _mm_set1_epi32(width);
+    const __m128i h = _mm_set1_epi32(height);
+    const __m128i tbh = _mm_set1_epi32(titleBarHeight);
+    const __m128i noSection = _mm_set1_epi32(static_cast<int>(Qt::NoSection));
+    const __m128i titleBar = _mm_set1_epi32(static_cast<int>(Qt::TitleBarArea));
+
+    // "a >= b" is "!(b > a)".
+    const auto inRange = [](const __m128i v, const __m128i lo, const __m128i hi) {
+        return _mm_andnot_si128(_mm_cmpgt_epi32(lo, v), _mm_cmplt_epi32(v, hi));
+    };
+    const auto select = [](const __m128i mask, const __m128i a, const __m128i b) {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    };
+
+    for (; i + 4 <= count; i += 4) {
+        const __m128i x = _mm_setr_epi32(points[i].x(), points[i + 1].x(), points[i + 2].x(), points[i + 3].x());
+        const __m128i y = _mm_setr_epi32(points[i].y(), points[i + 1].y(), points[i + 2].y(), points[i + 3].y());
+
+        const __m128i inX = inRange(x, zero, w);
+        __m128i result = select(_mm_and_si128(inX, inRange(y, zero, tbh)), titleBar, noSection);
+
+        // Walk backwards so that the zone with the highest priority is applied last.
+        for (int z = ZoneCount - 1; z >= 0; --z) {
+            const __m128i mask = _mm_and_si128(
+                inRange(x, _mm_set1_epi32(left[z]), _mm_set1_epi32(right[z])),
+                inRange(y, _mm_set1_epi32(top[z]), _mm_set1_epi32(bottom[z])));
+            result = select(mask, _mm_set1_epi32(static_cast<int>(kZoneSections[z])), result);
+        }
+
+        // Tiny windows may have zones sticking out, and the title bar
+        // height may be larger than the window height.
+        result = select(_mm_and_si128(inX, inRange(y, zero, h)), result, noSection);
+
+        alignas(16) int out[4];
+        _mm_store_si128(reinterpret_cast<__m128i *>(out), result);
+        for (int j = 0; j != 4; ++j) {
+            sections[i + j] = static_cast<Qt::WindowFrameSection>(out[j]);
+        }
+    }
+#elif defined(FRAMELESSHELPER_FRAMEZONES_NEON)
+    const int32x4_t zero = vdupq_n_s32(0);
+    const int32x4_t w = vdupq_n_s32(width);
+    const int32x4_t h = vdupq_n_s32(height);
+    const int32x4_t tbh = vdupq_n_s32(titleBarHeight);
+    const int32x4_t noSection = vdupq_n_s32(static_cast<int>(Qt::NoSection));
+    const int32x4_t titleBar = vdupq_n_s32(static_cast<int>(Qt::TitleBarArea));
+
+    const auto inRange = [](const int32x4_t v, const int32x4_t lo, const int32x4_t hi) {
+        return vandq_u32(vcgeq_s32(v, lo), vcltq_s32(v, hi));
+    };
+
+    for (; i + 4 <= count; i += 4) {
+        alignas(16) const int xs[4] = {points[i].x(), points[i + 1].x(), points[i + 2].x(), points[i + 3].x()};
+        alignas(16) const int ys[4] = {points[i].y(), points[i + 1].y(), points[i + 2].y(), points[i + 3].y()};
+        const int32x4_t x = vld1q_s32(xs);
+        const int32x4_t y = vld1q_s32(ys);
+
+        const uint32x4_t inX = inRange(x, zero, w);
+        int32x4_t result = vbslq_s32(vandq_u32(inX, inRange(y, zero, tbh)), titleBar, noSection);
+
+        // Walk backwards so that the zone with the highest priority is applied last.
+        for (int z = ZoneCount - 1; z >= 0; --z) {
+            const uint32x4_t mask = vandq_u32(
+                inRange(x, vdupq_n_s32(left[z]), vdupq_n_s32(right[z])),
+                inRange(y, vdupq_n_s32(top[z]), vdupq_n_s32(bottom[z])));
+            result = vbslq_s32(mask, vdupq_n_s32(static_cast<int>(kZoneSections[z])), result);
+        }
+
+        result = vbslq_s32(vandq_u32(inX, inRange(y, zero, h)), result, noSection);
+
+        alignas(16) int out[4];
+        vst1q_s32(out, result);
+        for (int j = 0; j != 4; ++j) {
+            sections[i + j] = static_cast<Qt::WindowFrameSection>(out[j]);
+        }
+    }
+#endif
+
+    // Scalar tail, or everything if there's no SIMD support.
+    for (; i < count; ++i) {
+        sections[i] = classify(points[i]);
+    }
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,66 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qnamespace.h>
+#include <QtCore/qpoint.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    Pre-computed hit test zones of a window, in window coordinates.
+
+    The eight resize zones are stored as a structure of arrays in hit test
+    priority order, so a whole batch of points can be classified with a few
+    vectorized compares (SSE2 or NEON, with a scalar fallback). Right and
+    bottom edges are exclusive.
+
+    The title bar strip is reported as Qt::TitleBarArea, it's up to the
+    caller to exclude the hit test visible objects from it.
+ */
+struct FrameZones
+{
+    enum { ZoneCount = 8 };
+
+    void update(const int windowWidth, const int windowHeight, const int borderThickness,
+                const int cornerSize, const int titleBarHeightValue);
+
+    Qt::WindowFrameSection classify(const QPoint &pos) const;
+    void classify(const QPoint *points, Qt::WindowFrameSection *sections, const int count) const;
+
+    int width = 0;
+    int height = 0;
+    int border = 0;
+    int corner = 0;
+    int titleBarHeight = 0;
+
+    alignas(16) int left[ZoneCount] = {};
+    alignas(16) int top[ZoneCount] = {};
+    alignas(16) int right[ZoneCount] = {};
+    alignas(16) int bottom[ZoneCount] = {};
+};
+
+FRAMELESSHELPER_END_NAMESPACE
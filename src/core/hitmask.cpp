@@ -0,0 +1,163 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "hitmask.h"
+#include <QtGui/qpainter.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+void HitMask::clear()
+{
+    m_source = Source::None;
+    m_path = QPainterPath();
+    m_image = QImage();
+    m_radius = 0.0;
+    m_size = QSize();
+    m_rowOffsets.clear();
+    m_spans.clear();
+}
+
+void HitMask::setPath(const QPainterPath &path)
+{
+    clear();
+    // Like a null image, an empty path removes the mask.
+    if (path.isEmpty()) {
+        return;
+    }
+    m_source = Source::Path;
+    m_path = path;
+}
+
+void HitMask::setImage(const QImage &image)
+{
+    clear();
+    if (image.isNull()) {
+        return;
+    }
+    m_source = Source::Image;
+    m_image = image;
+}
+
+void HitMask::setCornerRadius(const qreal radius)
+{
+    clear();
+    if (radius <= 0.0) {
+        return;
+    }
+    m_source = Source::RoundedRect;
+    m_radius = radius;
+}
+
+void HitMask::rebuild(const QSize &size)
+{
+    m_size = size;
+    m_rowOffsets.clear();
+    m_spans.clear();
+
+    if (isNull() || size.isEmpty()) {
+        return;
+    }
+
+    if (m_source == Source::Image) {
+        const QImage image = (m_image.size() == size)
+                ? m_image : m_image.scaled(size, Qt::IgnoreAspectRatio, Qt::FastTransformation);
+        buildFromAlpha(image.convertToFormat(QImage::Format_Alpha8));
+        return;
+    }
+
+    QImage alpha(size, QImage::Format_Alpha8);
+    alpha.fill(0);
+
+    QPainter painter(&alpha);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(Qt::black);
+    if (m_source == Source::RoundedRect) {
+        painter.drawRoundedRect(QRectF(QPointF(0, 0), size), m_radius, m_radius);
+    } else {
+        painter.drawPath(m_path);
+    }
+    painter.end();
+
+    buildFromAlpha(alpha);
+}
+
+void HitMask::buildFromAlpha(const QImage &alpha)
+{
+    const int width = alpha.width();
+    const int height = alpha.height();
+
+    m_rowOffsets.reserve(height + 1);
+    m_spans.reserve(height * 2);
+
+    for (int y = 0; y != height; ++y) {
+        m_rowOffsets.append(m_spans.size());
+        const uchar *line = alpha.constScanLine(y);
+        int x = 0;
+        while (x < width) {
+            // Anything that is not fully transparent is part of the window.
+            while (x < width && line[x] == 0) {
+                ++x;
+            }
+            if (x == width) {
+                break;
+            }
+            const int start = x;
+            while (x < width && line[x] != 0) {
+                ++x;
+            }
+            m_spans.append(start);
+            m_spans.append(x);
+        }
+    }
+    m_rowOffsets.append(m_spans.size());
+}
+
+bool HitMask::contains(const QPoint &pos) const
+{
+    if (isNull()) {
+        return true;
+    }
+
+    const int x = pos.x();
+    const int y = pos.y();
+    if (y < 0 || y >= (m_rowOffsets.size() - 1)) {
+        return false;
+    }
+
+    const int *spans = m_spans.constData();
+    const int begin = m_rowOffsets.at(y);
+    const int end = m_rowOffsets.at(y + 1);
+    for (int i = begin; i < end; i += 2) {
+        if (x < spans[i]) {
+            // Spans are sorted, nothing on the right can match.
+            return false;
+        }
+        if (x < spans[i + 1]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+FRAMELESSHELPER_END_NAMESPACE
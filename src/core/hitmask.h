@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qvector.h>
+#include <QtGui/qimage.h>
+#include <QtGui/qpainterpath.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    The hit-testable shape of a non-rectangular window, stored as a
+    run-length-encoded bitmap: every row keeps a list of [start, end)
+    spans of opaque pixels. The shape comes from a path, an image's alpha
+    channel or a rounded rectangle, and is rasterized again whenever the
+    window size changes, so a lookup never has to evaluate the source.
+
+    Rounded or otherwise convex shapes have a single span per row, so a
+    lookup is O(1).
+ */
+class HitMask
+{
+public:
+    bool isNull() const { return m_source == Source::None; }
+
+    void clear();
+    void setPath(const QPainterPath &path);
+    void setImage(const QImage &image);
+    void setCornerRadius(const qreal radius);
+
+    QSize size() const { return m_size; }
+    void rebuild(const QSize &size);
+
+    bool contains(const QPoint &pos) const;
+
+private:
+    enum class Source : int
+    {
+        None = 0,
+        Path,
+        Image,
+        RoundedRect
+    };
+
+    void buildFromAlpha(const QImage &alpha);
+
+    Source m_source = Source::None;
+    QPainterPath m_path;
+    QImage m_image;
+    qreal m_radius = 0.0;
+    QSize m_size;
+    // Spans of row y are m_spans[m_rowOffsets[y] .. m_rowOffsets[y + 1]),
+    // each span takes two ints.
+    QVector<int> m_rowOffsets;
+    QVector<int> m_spans;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
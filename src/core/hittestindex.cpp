@@ -0,0 +1,86 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "hittestindex.h"
+#include <algorithm>
+#include <limits>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+void HitTestIndex::clear()
+{
+    m_entries.clear();
+    m_maxRight.clear();
+}
+
+void HitTestIndex::build(const QVector<QRect> &rects)
+{
+    clear();
+
+    m_entries.reserve(rects.size());
+    for (const QRect &rect : rects) {
+        if (rect.isEmpty()) {
+            continue;
+        }
+        m_entries.append({rect.left(), rect.top(), rect.left() + rect.width(), rect.top() + rect.height()});
+    }
+
+    std::sort(m_entries.begin(), m_entries.end(), [](const Entry &lhs, const Entry &rhs) {
+        return lhs.left < rhs.left;
+    });
+
+    m_maxRight.reserve(m_entries.size());
+    int maxRight = std::numeric_limits<int>::min();
+    for (const Entry &entry : qAsConst(m_entries)) {
+        maxRight = qMax(maxRight, entry.right);
+        m_maxRight.append(maxRight);
+    }
+}
+
+bool HitTestIndex::contains(const QPoint &pos) const
+{
+    const int x = pos.x();
+    const int y = pos.y();
+
+    // First entry which starts on the right of the point.
+    const auto it = std::upper_bound(m_entries.cbegin(), m_entries.cend(), x,
+        [](const int value, const Entry &entry) {
+            return value < entry.left;
+        });
+
+    for (int i = static_cast<int>(it - m_entries.cbegin()) - 1; i >= 0; --i) {
+        if (m_maxRight.at(i) <= x) {
+            // Nothing on the left reaches the point.
+            break;
+        }
+        const Entry &entry = m_entries.at(i);
+        if (x < entry.right && y >= entry.top && y < entry.bottom) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,66 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qrect.h>
+#include <QtCore/qvector.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    A read-mostly index of the hit test visible rectangles inside the title
+    bar. The rectangles are kept sorted by their left edge together with the
+    running maximum of their right edges, so a point query is a binary search
+    followed by a short backwards scan which stops as soon as no rectangle on
+    the left can reach the point any more. Title bar controls rarely overlap,
+    so in practice a query costs O(log n).
+ */
+class HitTestIndex
+{
+public:
+    void clear();
+    void build(const QVector<QRect> &rects);
+
+    bool contains(const QPoint &pos) const;
+
+    int size() const { return m_entries.size(); }
+    bool isEmpty() const { return m_entries.isEmpty(); }
+
+private:
+    // Right and bottom are exclusive, unlike QRect.
+    struct Entry
+    {
+        int left;
+        int top;
+        int right;
+        int bottom;
+    };
+
+    QVector<Entry> m_entries;
+    QVector<int> m_maxRight;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
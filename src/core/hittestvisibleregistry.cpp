@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "hittestvisibleregistry.h"
+#include <QtCore/qhash.h>
+#include <QtGui/qwindow.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+struct HitTestVisibleWindowData
+{
+    ObjectRegistry<HitTestVisibleRegistry::Entry> objects;
+    QMetaObject::Connection connection;
+};
+
+struct HitTestVisibleRegistryData
+{
+    // Receiver of all the destroyed() connections, they go away with it.
+    QObject context;
+    QHash<const QWindow *, HitTestVisibleWindowData> windows;
+};
+
+Q_GLOBAL_STATIC(HitTestVisibleRegistryData, g_hitTestVisibleRegistryData)
+
+static void removeWindow(const QWindow *window)
+{
+    HitTestVisibleRegistryData *data = g_hitTestVisibleRegistryData();
+    if (!data) {
+        return;
+    }
+    const auto it = data->windows.find(window);
+    if (it == data->windows.end()) {
+        return;
+    }
+    for (const HitTestVisibleRegistry::Entry &entry : qAsConst(it->objects)) {
+        QObject::disconnect(entry.connection);
+    }
+    QObject::disconnect(it->connection);
+    data->windows.erase(it);
+}
+
+bool HitTestVisibleRegistry::add(QWindow *window, QObject *object, const ObjectKind kind)
+{
+    Q_ASSERT(window);
+    Q_ASSERT(object);
+    HitTestVisibleRegistryData *data = g_hitTestVisibleRegistryData();
+    if (!window || !object || !data) {
+        return false;
+    }
+    auto it = data->windows.find(window);
+    if (it == data->windows.end()) {
+        it = data->windows.insert(window, {});
+        // The window is half destroyed, only its address is used.
+        it->connection = QObject::connect(window, &QObject::destroyed, &data->context, [window](){
+            removeWindow(window);
+        });
+    } else if (it->objects.contains(object)) {
+        return false;
+    }
+    Entry entry;
+    entry.object = object;
+    entry.kind = kind;
+    entry.connection = QObject::connect(object, &QObject::destroyed, &data->context, [window, object](){
+        HitTestVisibleRegistry::remove(window, object);
+    });
+    return it->objects.insert(entry);
+}
+
+bool HitTestVisibleRegistry::remove(const QWindow *window, const QObject *object)
+{
+    HitTestVisibleRegistryData *data = g_hitTestVisibleRegistryData();
+    if (!window || !object || !data) {
+        return false;
+    }
+    const auto it = data->windows.find(window);
+    if (it == data->windows.end()) {
+        return false;
+    }
+    const Entry *entry = it->objects.find(object);
+    if (!entry) {
+        return false;
+    }
+    QObject::disconnect(entry->connection);
+    it->objects.remove(object);
+    if (it->objects.isEmpty()) {
+        removeWindow(window);
+    }
+    return true;
+}
+
+const ObjectRegistry<HitTestVisibleRegistry::Entry> *HitTestVisibleRegistry::objects(const QWindow *window)
+{
+    HitTestVisibleRegistryData *data = g_hitTestVisibleRegistryData();
+    if (!window || !data) {
+        return nullptr;
+    }
+    const auto it = data->windows.constFind(window);
+    return it == data->windows.constEnd() ? nullptr : &it->objects;
+}
+
+int HitTestVisibleRegistry::size(const QWindow *window)
+{
+    const ObjectRegistry<Entry> *registry = objects(window);
+    return registry ? registry->size() : 0;
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,62 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include "objectgeometry.h"
+#include "objectregistry.h"
+#include <QtCore/qobject.h>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QWindow)
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    The hit test visible objects registered through FramelessWindowsManager,
+    per window. Objects are dropped as soon as they are destroyed, and a
+    window's registry is dropped together with the window.
+ */
+namespace HitTestVisibleRegistry
+{
+
+struct Entry
+{
+    QObject *object = nullptr;
+    ObjectKind kind = ObjectKind::Unknown;
+    QMetaObject::Connection connection;
+};
+
+bool add(QWindow *window, QObject *object, const ObjectKind kind);
+bool remove(const QWindow *window, const QObject *object);
+
+// Valid until the registry of the window is changed.
+const ObjectRegistry<Entry> *objects(const QWindow *window);
+int size(const QWindow *window);
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,344 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "objectgeometry.h"
+#include <QtCore/qobject.h>
+#include <QtCore/qmetaobject.h>
+#include <QtCore/qvariant.h>
+#include <QtCore/qvector.h>
+#ifdef QT_WIDGETS_LIB
+#include <QtWidgets/qwidget.h>
+#endif
+#ifdef QT_QUICK_LIB
+#include <QtQuick/qquickitem.h>
+#endif
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+static QMetaMethod slotMethod(const QObject *receiver, const char *slot)
+{
+    const QMetaObject *metaObject = receiver->metaObject();
+    return metaObject->method(metaObject->indexOfMethod(QMetaObject::normalizedSignature(slot).constData()));
+}
+
+static void connectSignals(QObject *object, const QVector<QMetaMethod> &signals_, QObject *receiver, const QMetaMethod &slot)
+{
+    for (const QMetaMethod &signal : signals_) {
+        if (signal.isValid() && slot.isValid()) {
+            QObject::connect(object, signal, receiver, slot, Qt::UniqueConnection);
+        }
+    }
+}
+
+template <typename T>
+struct GeometryAccessor
+{
+    // Generic fallback, only used when the real type is not available.
+    static QRect windowRect(const QObject *object)
+    {
+        QPointF localPos = {object->property("x").toReal(), object->property("y").toReal()};
+        for (QObject *p = object->parent(); p; p = p->parent()) {
+            // If parent is nullptr, the QWidget is a window.
+            if (p->parent() == nullptr)
+                break;
+            // Top-level window of QQuickItem is a QWindow.
+            if (p->isWindowType())
+                break;
+            localPos += {p->property("x").toReal(), p->property("y").toReal()};
+        }
+        return QRect(localPos.toPoint(),
+                     QSize(object->property("width").toInt(), object->property("height").toInt()));
+    }
+
+    static QPoint globalPos(const QObject *object)
+    {
+        QPointF point = {object->property("x").toReal(), object->property("y").toReal()};
+        for (QObject *parent = object->parent(); parent; parent = parent->parent()) {
+            point += {parent->property("x").toReal(), parent->property("y").toReal()};
+            if (parent->isWindowType()) {
+                break;
+            }
+        }
+        return point.toPoint();
+    }
+
+    static bool isVisible(const QObject *object)
+    {
+        return object->property("visible").toBool();
+    }
+
+    static QObject *parentObject(const QObject *object)
+    {
+        return object->parent();
+    }
+
+    static QObjectList childObjects(const QObject *object)
+    {
+        return object->children();
+    }
+
+    static void watchGeometry(QObject *object, QObject *receiver, const char *geometrySlot, const char *hierarchySlot)
+    {
+        // Only what the object really has, connecting by name would warn.
+        const QMetaObject *metaObject = object->metaObject();
+        const auto signal = [metaObject](const char *signature) {
+            return metaObject->method(metaObject->indexOfSignal(signature));
+        };
+        connectSignals(object, {signal("xChanged()"), signal("yChanged()"), signal("widthChanged()"),
+                                signal("heightChanged()"), signal("visibleChanged()"), signal("scaleChanged()"),
+                                signal("rotationChanged()"), signal("transformOriginChanged(TransformOrigin)")},
+                       receiver, slotMethod(receiver, geometrySlot));
+        connectSignals(object, {signal("parentChanged(QQuickItem*)")}, receiver, slotMethod(receiver, hierarchySlot));
+    }
+
+    static bool isInteractive(const QObject *object)
+    {
+        // The accepted mouse buttons of a QQuickItem are not a property.
+        return object->inherits("QAbstractButton")
+                || object->inherits("QLineEdit")
+                || object->inherits("QMenuBar")
+                || object->inherits("QComboBox");
+    }
+};
+
+#ifdef QT_WIDGETS_LIB
+using WidgetType = QWidget;
+
+template <>
+struct GeometryAccessor<QWidget>
+{
+    static QRect windowRect(const QWidget *widget)
+    {
+        return QRect(widget->mapTo(widget->window(), QPoint(0, 0)), widget->size());
+    }
+
+    static QPoint globalPos(const QWidget *widget)
+    {
+        return widget->mapToGlobal(QPoint(0, 0));
+    }
+
+    static bool isVisible(const QWidget *widget)
+    {
+        return widget->isVisible();
+    }
+
+    static QObject *parentObject(const QWidget *widget)
+    {
+        return widget->parentWidget();
+    }
+
+    static QObjectList childObjects(const QWidget *widget)
+    {
+        return widget->children();
+    }
+
+    static bool isInteractive(const QWidget *widget)
+    {
+        return widget->inherits("QAbstractButton")
+                || widget->inherits("QLineEdit")
+                || widget->inherits("QMenuBar")
+                || widget->inherits("QComboBox");
+    }
+};
+#else
+using WidgetType = QObject;
+#endif
+
+#ifdef QT_QUICK_LIB
+using QuickItemType = QQuickItem;
+
+template <>
+struct GeometryAccessor<QQuickItem>
+{
+    static QRect windowRect(const QQuickItem *item)
+    {
+        // The scene is the whole window.
+        return item->mapRectToScene(QRectF(0, 0, item->width(), item->height())).toAlignedRect();
+    }
+
+    static QPoint globalPos(const QQuickItem *item)
+    {
+        return item->mapToGlobal(QPointF(0, 0)).toPoint();
+    }
+
+    static bool isVisible(const QQuickItem *item)
+    {
+        return item->isVisible();
+    }
+
+    static QObject *parentObject(const QQuickItem *item)
+    {
+        return item->parentItem();
+    }
+
+    static QObjectList childObjects(const QQuickItem *item)
+    {
+        QObjectList children;
+        const QList<QQuickItem *> items = item->childItems();
+        children.reserve(items.size());
+        for (QQuickItem *child : items) {
+            children.append(child);
+        }
+        return children;
+    }
+
+    static void watchGeometry(QQuickItem *item, QObject *receiver, const char *geometrySlot, const char *hierarchySlot)
+    {
+        connectSignals(item, {QMetaMethod::fromSignal(&QQuickItem::xChanged),
+                              QMetaMethod::fromSignal(&QQuickItem::yChanged),
+                              QMetaMethod::fromSignal(&QQuickItem::widthChanged),
+                              QMetaMethod::fromSignal(&QQuickItem::heightChanged),
+                              QMetaMethod::fromSignal(&QQuickItem::visibleChanged),
+                              QMetaMethod::fromSignal(&QQuickItem::scaleChanged),
+                              QMetaMethod::fromSignal(&QQuickItem::rotationChanged),
+                              QMetaMethod::fromSignal(&QQuickItem::transformOriginChanged)},
+                       receiver, slotMethod(receiver, geometrySlot));
+        connectSignals(item, {QMetaMethod::fromSignal(&QQuickItem::parentChanged)},
+                       receiver, slotMethod(receiver, hierarchySlot));
+    }
+
+    static bool isInteractive(const QQuickItem *item)
+    {
+        return item->acceptedMouseButtons() != Qt::NoButton;
+    }
+};
+#else
+using QuickItemType = QObject;
+#endif
+
+ObjectKind ObjectGeometry::kindOf(const QObject *object)
+{
+    if (!object) {
+        return ObjectKind::Unknown;
+    }
+    if (object->isWidgetType()) {
+        return ObjectKind::Widget;
+    }
+#ifdef QT_QUICK_LIB
+    if (qobject_cast<const QQuickItem *>(object)) {
+#else
+    if (object->inherits("QQuickItem")) {
+#endif
+        return ObjectKind::QuickItem;
+    }
+    return ObjectKind::Unknown;
+}
+
+QRect ObjectGeometry::windowRect(const QObject *object, const ObjectKind kind)
+{
+    Q_ASSERT(object);
+    switch (kind) {
+    case ObjectKind::Widget:
+        return GeometryAccessor<WidgetType>::windowRect(static_cast<const WidgetType *>(object));
+    case ObjectKind::QuickItem:
+        return GeometryAccessor<QuickItemType>::windowRect(static_cast<const QuickItemType *>(object));
+    case ObjectKind::Unknown:
+        break;
+    }
+    return {};
+}
+
+QPoint ObjectGeometry::globalPos(const QObject *object, const ObjectKind kind)
+{
+    Q_ASSERT(object);
+    switch (kind) {
+    case ObjectKind::Widget:
+        return GeometryAccessor<WidgetType>::globalPos(static_cast<const WidgetType *>(object));
+    case ObjectKind::QuickItem:
+        return GeometryAccessor<QuickItemType>::globalPos(static_cast<const QuickItemType *>(object));
+    case ObjectKind::Unknown:
+        break;
+    }
+    return {};
+}
+
+bool ObjectGeometry::isVisible(const QObject *object, const ObjectKind kind)
+{
+    Q_ASSERT(object);
+    switch (kind) {
+    case ObjectKind::Widget:
+        return GeometryAccessor<WidgetType>::isVisible(static_cast<const WidgetType *>(object));
+    case ObjectKind::QuickItem:
+        return GeometryAccessor<QuickItemType>::isVisible(static_cast<const QuickItemType *>(object));
+    case ObjectKind::Unknown:
+        break;
+    }
+    return false;
+}
+
+QObject *ObjectGeometry::parentObject(const QObject *object, const ObjectKind kind)
+{
+    Q_ASSERT(object);
+    switch (kind) {
+    case ObjectKind::Widget:
+        return GeometryAccessor<WidgetType>::parentObject(static_cast<const WidgetType *>(object));
+    case ObjectKind::QuickItem:
+        return GeometryAccessor<QuickItemType>::parentObject(static_cast<const QuickItemType *>(object));
+    case ObjectKind::Unknown:
+        break;
+    }
+    return object->parent();
+}
+
+QObjectList ObjectGeometry::childObjects(const QObject *object, const ObjectKind kind)
+{
+    Q_ASSERT(object);
+    switch (kind) {
+    case ObjectKind::Widget:
+        return GeometryAccessor<WidgetType>::childObjects(static_cast<const WidgetType *>(object));
+    case ObjectKind::QuickItem:
+        return GeometryAccessor<QuickItemType>::childObjects(static_cast<const QuickItemType *>(object));
+    case ObjectKind::Unknown:
+        break;
+    }
+    return {};
+}
+
+void ObjectGeometry::watchGeometry(QObject *object, const ObjectKind kind, QObject *receiver,
+                                   const char *geometrySlot, const char *hierarchySlot)
+{
+    Q_ASSERT(object);
+    Q_ASSERT(receiver);
+    if (!object || !receiver || kind != ObjectKind::QuickItem) {
+        return;
+    }
+    GeometryAccessor<QuickItemType>::watchGeometry(static_cast<QuickItemType *>(object), receiver,
+                                                   geometrySlot, hierarchySlot);
+}
+
+bool ObjectGeometry::isInteractive(const QObject *object, const ObjectKind kind)
+{
+    Q_ASSERT(object);
+    switch (kind) {
+    case ObjectKind::Widget:
+        return GeometryAccessor<WidgetType>::isInteractive(static_cast<const WidgetType *>(object));
+    case ObjectKind::QuickItem:
+        return GeometryAccessor<QuickItemType>::isInteractive(static_cast<const QuickItemType *>(object));
+    case ObjectKind::Unknown:
+        break;
+    }
+    return false;
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,78 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qrect.h>
+#include <QtCore/qobject.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+enum class ObjectKind : int
+{
+    Unknown = 0,
+    Widget,
+    QuickItem
+};
+
+/*!
+    Geometry accessors for QWidgets and QQuickItems. The kind of an object
+    is resolved once (usually when it's registered) and every later query
+    is dispatched to a typed implementation, instead of going through the
+    dynamic property system and a class name comparison on each call.
+
+    If the library is built without QtWidgets or QtQuick, the corresponding
+    kind falls back to the "x", "y", "width", "height" and "visible"
+    properties.
+ */
+namespace ObjectGeometry
+{
+
+ObjectKind kindOf(const QObject *object);
+
+// Relative to the top level window, item transforms are taken into account.
+QRect windowRect(const QObject *object, const ObjectKind kind);
+QPoint globalPos(const QObject *object, const ObjectKind kind);
+bool isVisible(const QObject *object, const ObjectKind kind);
+
+// The visual hierarchy, which is not the QObject one for QQuickItems.
+QObject *parentObject(const QObject *object, const ObjectKind kind);
+QObjectList childObjects(const QObject *object, const ObjectKind kind);
+
+// Connects the geometry, visibility and transform notifications of a
+// QQuickItem to the \a geometrySlot of \a receiver, and its parent changes
+// to \a hierarchySlot. Slots are given by signature, e.g. "update()".
+// Widgets have no such signals, they are watched through events.
+void watchGeometry(QObject *object, const ObjectKind kind, QObject *receiver,
+                   const char *geometrySlot, const char *hierarchySlot);
+
+// Whether the object consumes mouse presses by itself, such as a button,
+// a line edit, a menu bar, a combo box or a QQuickItem that accepts
+// mouse buttons.
+bool isInteractive(const QObject *object, const ObjectKind kind);
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
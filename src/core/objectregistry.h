@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qhash.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QObject)
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    A set of per-object entries with O(1) insertion, removal and lookup.
+
+    The entries are stored contiguously, so iterating over them is a plain
+    linear scan without holes. Removing an entry moves the last one into
+    its slot, the order is not preserved. The storage shrinks again once
+    most of it is unused.
+
+    \c T must have a \c {QObject *object} member. The registry doesn't watch
+    the objects, its owner removes them when they are destroyed.
+ */
+template <typename T>
+class ObjectRegistry
+{
+public:
+    using iterator = typename QVector<T>::iterator;
+    using const_iterator = typename QVector<T>::const_iterator;
+
+    bool insert(const T &entry)
+    {
+        Q_ASSERT(entry.object);
+        if (!entry.object || m_index.contains(entry.object)) {
+            return false;
+        }
+        m_index.insert(entry.object, m_entries.size());
+        m_entries.append(entry);
+        return true;
+    }
+
+    bool remove(const QObject *object)
+    {
+        const auto it = m_index.find(object);
+        if (it == m_index.end()) {
+            return false;
+        }
+        const int index = it.value();
+        m_index.erase(it);
+        removeAt(index);
+        return true;
+    }
+
+    template <typename Predicate>
+    int removeIf(Predicate predicate)
+    {
+        int removed = 0;
+        for (int i = 0; i < m_entries.size();) {
+            if (predicate(m_entries.at(i))) {
+                m_index.remove(m_entries.at(i).object);
+                // The last entry has been moved here, look at it again.
+                removeAt(i);
+                ++removed;
+            } else {
+                ++i;
+            }
+        }
+        return removed;
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+        m_entries.squeeze();
+        m_index.clear();
+        m_index.squeeze();
+    }
+
+    bool contains(const QObject *object) const { return m_index.contains(object); }
+
+    T *find(const QObject *object)
+    {
+        const auto it = m_index.constFind(object);
+        return it == m_index.constEnd() ? nullptr : &m_entries[it.value()];
+    }
+
+    const T *find(const QObject *object) const
+    {
+        const auto it = m_index.constFind(object);
+        return it == m_index.constEnd() ? nullptr : &m_entries.at(it.value());
+    }
+
+    int size() const { return m_entries.size(); }
+    bool isEmpty() const { return m_entries.isEmpty(); }
+    const T &at(const int index) const { return m_entries.at(index); }
+
+    iterator begin() { return m_entries.begin(); }
+    iterator end() { return m_entries.end(); }
+    const_iterator begin() const { return m_entries.cbegin(); }
+    const_iterator end() const { return m_entries.cend(); }
+
+private:
+    void removeAt(const int index)
+    {
+        const int last = m_entries.size() - 1;
+        if (index != last) {
+            m_entries[index] = m_entries.at(last);
+            m_index[m_entries.at(index).object] = index;
+        }
+        m_entries.removeLast();
+
+        // Long-running applications register and destroy objects all the
+        // time, give the memory back after a burst.
+        if (m_entries.capacity() > 64 && m_entries.size() < m_entries.capacity() / 4) {
+            m_entries.squeeze();
+            m_index.squeeze();
+        }
+    }
+
+    QVector<T> m_entries;
+    QHash<const QObject *, int> m_index;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,368 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "spanregion.h"
+#include <algorithm>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+void SpanRegion::clear()
+{
+    m_buffers[m_front].bands.clear();
+    m_buffers[m_front].spans.clear();
+}
+
+void SpanRegion::setRect(const QRect &rect)
+{
+    clear();
+    unite(rect);
+}
+
+void SpanRegion::unite(const QRect &rect)
+{
+    apply(rect, Op::Unite);
+}
+
+void SpanRegion::subtract(const QRect &rect)
+{
+    apply(rect, Op::Subtract);
+}
+
+/*!
+    Subtract \a count rectangles at once, sorted by their top edge. The
+    bands are swept a single time, no matter how many rectangles there are.
+ */
+void SpanRegion::subtract(const QRect *rects, const int count)
+{
+    if (count <= 0 || isEmpty()) {
+        return;
+    }
+
+    const Buffer &in = m_buffers[m_front];
+    Buffer &out = m_buffers[1 - m_front];
+    out.bands.clear();
+    out.spans.clear();
+
+    appendEdges(in, rects, count);
+
+    m_active.clear();
+    int next = 0;
+    int bandIndex = 0;
+    for (int i = 0; i + 1 < m_edges.size(); ++i) {
+        const int top = m_edges.at(i);
+        const int bottom = m_edges.at(i + 1);
+
+        while (bandIndex < in.bands.size() && in.bands.at(bandIndex).bottom <= top) {
+            ++bandIndex;
+        }
+
+        const Span *spans = nullptr;
+        int spanCount = 0;
+        if (bandIndex < in.bands.size() && in.bands.at(bandIndex).top <= top) {
+            const Band &band = in.bands.at(bandIndex);
+            spans = in.spans.constData() + band.first;
+            spanCount = band.count;
+        }
+
+        // Every edge is in the list, so an active rectangle covers the whole piece.
+        for (; next < count && rects[next].y() <= top; ++next) {
+            if (!rects[next].isEmpty()) {
+                m_active.append(next);
+            }
+        }
+        int kept = 0;
+        for (int j = 0; j < m_active.size(); ++j) {
+            const QRect &rect = rects[m_active.at(j)];
+            if (rect.y() + rect.height() > top) {
+                m_active[kept++] = m_active.at(j);
+            }
+        }
+        m_active.resize(kept);
+
+        const int first = out.spans.size();
+        if (m_active.isEmpty()) {
+            if (spanCount > 0) {
+                out.spans.append(spans, spanCount);
+            }
+        } else if (spanCount > 0) {
+            m_cuts.clear();
+            for (const int index : qAsConst(m_active)) {
+                const QRect &rect = rects[index];
+                m_cuts.append({rect.x(), rect.x() + rect.width()});
+            }
+            std::sort(m_cuts.begin(), m_cuts.end(), [](const Span &a, const Span &b) {
+                return a.left < b.left;
+            });
+            // Merge the overlapping cuts, so they can be walked together with the spans.
+            int cutCount = 1;
+            for (int j = 1; j < m_cuts.size(); ++j) {
+                Span &last = m_cuts[cutCount - 1];
+                if (m_cuts.at(j).left <= last.right) {
+                    last.right = qMax(last.right, m_cuts.at(j).right);
+                } else {
+                    m_cuts[cutCount++] = m_cuts.at(j);
+                }
+            }
+            subtractSpans(spans, spanCount, m_cuts.constData(), cutCount, out.spans);
+        }
+
+        if (out.spans.size() > first) {
+            appendBand(out, top, bottom, first);
+        }
+    }
+
+    m_front = 1 - m_front;
+}
+
+void SpanRegion::intersect(const QRect &rect)
+{
+    apply(rect, Op::Intersect);
+}
+
+bool SpanRegion::contains(const QPoint &pos) const
+{
+    const Buffer &buffer = m_buffers[m_front];
+
+    const auto band = std::upper_bound(buffer.bands.cbegin(), buffer.bands.cend(), pos.y(),
+                                       [](const int y, const Band &b) { return y < b.bottom; });
+    if (band == buffer.bands.cend() || pos.y() < band->top) {
+        return false;
+    }
+
+    const Span *first = buffer.spans.constData() + band->first;
+    const Span *last = first + band->count;
+    const Span *span = std::upper_bound(first, last, pos.x(),
+                                        [](const int x, const Span &s) { return x < s.right; });
+    return span != last && pos.x() >= span->left;
+}
+
+QRegion SpanRegion::toRegion() const
+{
+    const Buffer &buffer = m_buffers[m_front];
+
+    QVarLengthArray<QRect, 64> rects;
+    rects.reserve(buffer.spans.size());
+    for (const Band &band : buffer.bands) {
+        for (int i = band.first; i < band.first + band.count; ++i) {
+            const Span &span = buffer.spans.at(i);
+            rects.append(QRect(span.left, band.top, span.right - span.left, band.bottom - band.top));
+        }
+    }
+
+    // Already banded and sorted the way QRegion stores its rectangles.
+    QRegion region;
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 8, 0))
+    region.setRects(rects);
+#else
+    region.setRects(rects.constData(), rects.size());
+#endif
+    return region;
+}
+
+/*!
+    Cut the bands at the edges of \a rect, combine the spans of the bands
+    it covers with its horizontal extent, and merge equal adjacent bands
+    back together.
+ */
+void SpanRegion::apply(const QRect &rect, const Op op)
+{
+    if (rect.isEmpty()) {
+        if (op == Op::Intersect) {
+            clear();
+        }
+        return;
+    }
+
+    const Buffer &in = m_buffers[m_front];
+    Buffer &out = m_buffers[1 - m_front];
+    out.bands.clear();
+    out.spans.clear();
+
+    const int rectTop = rect.y();
+    const int rectBottom = rect.y() + rect.height();
+    const int rectLeft = rect.x();
+    const int rectRight = rect.x() + rect.width();
+
+    appendEdges(in, &rect, 1);
+
+    int bandIndex = 0;
+    for (int i = 0; i + 1 < m_edges.size(); ++i) {
+        const int top = m_edges.at(i);
+        const int bottom = m_edges.at(i + 1);
+
+        while (bandIndex < in.bands.size() && in.bands.at(bandIndex).bottom <= top) {
+            ++bandIndex;
+        }
+
+        // Every edge is in the list, so the piece is inside a band or a gap.
+        const Span *spans = nullptr;
+        int spanCount = 0;
+        if (bandIndex < in.bands.size() && in.bands.at(bandIndex).top <= top) {
+            const Band &band = in.bands.at(bandIndex);
+            spans = in.spans.constData() + band.first;
+            spanCount = band.count;
+        }
+
+        const bool covered = top >= rectTop && bottom <= rectBottom;
+        const int first = out.spans.size();
+        combine(spans, spanCount, covered, rectLeft, rectRight, op, out.spans);
+        if (out.spans.size() > first) {
+            appendBand(out, top, bottom, first);
+        }
+    }
+
+    m_front = 1 - m_front;
+}
+
+/*!
+    Collect the sorted and unique edges of the bands of \a in and of the
+    non-empty \a rects into m_edges.
+ */
+void SpanRegion::appendEdges(const Buffer &in, const QRect *rects, const int count)
+{
+    m_edges.clear();
+    for (const Band &band : in.bands) {
+        m_edges.append(band.top);
+        m_edges.append(band.bottom);
+    }
+    for (int i = 0; i < count; ++i) {
+        if (!rects[i].isEmpty()) {
+            m_edges.append(rects[i].y());
+            m_edges.append(rects[i].y() + rects[i].height());
+        }
+    }
+    std::sort(m_edges.begin(), m_edges.end());
+    m_edges.resize(int(std::unique(m_edges.begin(), m_edges.end()) - m_edges.begin()));
+}
+
+/*!
+    Add the spans written from \a first on as a new band, or merge them into
+    the previous band when it's adjacent and equal.
+ */
+void SpanRegion::appendBand(Buffer &out, const int top, const int bottom, const int first)
+{
+    const int count = out.spans.size() - first;
+
+    if (!out.bands.isEmpty()) {
+        Band &previous = out.bands.last();
+        const auto equal = [](const Span &a, const Span &b) {
+            return a.left == b.left && a.right == b.right;
+        };
+        if (previous.bottom == top && previous.count == count
+                && std::equal(out.spans.constData() + previous.first,
+                              out.spans.constData() + previous.first + count,
+                              out.spans.constData() + first, equal)) {
+            previous.bottom = bottom;
+            out.spans.resize(first);
+            return;
+        }
+    }
+
+    out.bands.append({top, bottom, first, count});
+}
+
+void SpanRegion::combine(const Span *spans, const int count, const bool covered,
+                         const int left, const int right, const Op op, SpanArray &out)
+{
+    if (!covered) {
+        if (op != Op::Intersect && count > 0) {
+            out.append(spans, count);
+        }
+        return;
+    }
+
+    switch (op) {
+    case Op::Unite:
+    {
+        int i = 0;
+        for (; i < count && spans[i].right < left; ++i) {
+            out.append(spans[i]);
+        }
+        // Merge everything overlapping or touching the new span.
+        Span merged = {left, right};
+        for (; i < count && spans[i].left <= right; ++i) {
+            merged.left = qMin(merged.left, spans[i].left);
+            merged.right = qMax(merged.right, spans[i].right);
+        }
+        out.append(merged);
+        if (i < count) {
+            out.append(spans + i, count - i);
+        }
+        break;
+    }
+    case Op::Subtract:
+        for (int i = 0; i < count; ++i) {
+            const Span &span = spans[i];
+            if (span.right <= left || span.left >= right) {
+                out.append(span);
+                continue;
+            }
+            if (span.left < left) {
+                out.append({span.left, left});
+            }
+            if (span.right > right) {
+                out.append({right, span.right});
+            }
+        }
+        break;
+    case Op::Intersect:
+        for (int i = 0; i < count; ++i) {
+            const int l = qMax(spans[i].left, left);
+            const int r = qMin(spans[i].right, right);
+            if (l < r) {
+                out.append({l, r});
+            }
+        }
+        break;
+    }
+}
+
+/*!
+    Remove the sorted and non-overlapping \a cuts from the sorted \a spans,
+    walking both lists together.
+ */
+void SpanRegion::subtractSpans(const Span *spans, const int count,
+                               const Span *cuts, const int cutCount, SpanArray &out)
+{
+    int cut = 0;
+    for (int i = 0; i < count; ++i) {
+        int left = spans[i].left;
+        const int right = spans[i].right;
+        while (cut < cutCount && cuts[cut].right <= left) {
+            ++cut;
+        }
+        for (int j = cut; left < right; ++j) {
+            if (j == cutCount || cuts[j].left >= right) {
+                out.append({left, right});
+                break;
+            }
+            if (cuts[j].left > left) {
+                out.append({left, cuts[j].left});
+            }
+            left = cuts[j].right;
+        }
+    }
+}
+
+FRAMELESSHELPER_END_NAMESPACE
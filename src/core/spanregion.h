@@ -0,0 +1,108 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qrect.h>
+#include <QtCore/qvarlengtharray.h>
+#include <QtGui/qregion.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    A region made of sorted horizontal bands, each holding sorted and
+    non-overlapping spans, kept in inline buffers.
+
+    It's meant to be kept around and rebuilt in place: as long as the
+    region fits into the inline capacity (or into the capacity it grew to
+    earlier) no memory is allocated. Every operation is linear in the
+    number of spans. Convert it with toRegion() only when a QRegion is
+    really needed.
+ */
+class SpanRegion
+{
+public:
+    void clear();
+    void setRect(const QRect &rect);
+
+    void unite(const QRect &rect);
+    void subtract(const QRect &rect);
+    void subtract(const QRect *rects, const int count);
+    void intersect(const QRect &rect);
+
+    bool isEmpty() const { return m_buffers[m_front].bands.isEmpty(); }
+    bool contains(const QPoint &pos) const;
+    QRegion toRegion() const;
+
+private:
+    enum class Op : int
+    {
+        Unite = 0,
+        Subtract,
+        Intersect
+    };
+
+    // Right and bottom are exclusive.
+    struct Span
+    {
+        int left;
+        int right;
+    };
+
+    struct Band
+    {
+        int top;
+        int bottom;
+        int first;
+        int count;
+    };
+
+    using SpanArray = QVarLengthArray<Span, 64>;
+
+    struct Buffer
+    {
+        QVarLengthArray<Band, 16> bands;
+        SpanArray spans;
+    };
+
+    void apply(const QRect &rect, const Op op);
+    void appendEdges(const Buffer &in, const QRect *rects, const int count);
+    static void appendBand(Buffer &out, const int top, const int bottom, const int first);
+    static void combine(const Span *spans, const int count, const bool covered,
+                        const int left, const int right, const Op op, SpanArray &out);
+    static void subtractSpans(const Span *spans, const int count,
+                              const Span *cuts, const int cutCount, SpanArray &out);
+
+    // Operations read one buffer and write the other one, then swap them.
+    Buffer m_buffers[2];
+    int m_front = 0;
+
+    // Scratch space of the operations, kept to reuse what it grew to.
+    QVarLengthArray<int, 34> m_edges;
+    QVarLengthArray<int, 16> m_active;
+    SpanArray m_cuts;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,152 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "systemmetriccache.h"
+#include "utilities.h"
+#include <QtCore/qhash.h>
+#include <QtGui/qscreen.h>
+#include <QtGui/qwindow.h>
+#include <algorithm>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// Metric, dpiScale, forceSystemValue and maximized (or full screen).
+static constexpr int kMetricCount = static_cast<int>(SystemMetric::TitleBarHeight) + 1;
+static constexpr int kMetricSlotCount = kMetricCount * 2 * 2 * 2;
+
+struct ScreenMetrics
+{
+    qreal devicePixelRatio = 0.0;
+    // -1 until computed.
+    int values[kMetricSlotCount];
+
+    void reset()
+    {
+        devicePixelRatio = 0.0;
+        std::fill(values, values + kMetricSlotCount, -1);
+    }
+};
+
+struct SystemMetricCacheData
+{
+    // Receiver of the screen connections, they go away with it.
+    QObject context;
+    SystemMetricNotifier notifier;
+    QHash<const QScreen *, ScreenMetrics> screens;
+};
+
+Q_GLOBAL_STATIC(SystemMetricCacheData, g_systemMetricCacheData)
+
+static int metricSlot(const SystemMetric metric, const bool dpiScale, const bool forceSystemValue, const bool maximized)
+{
+    return (((static_cast<int>(metric) * 2) + (dpiScale ? 1 : 0)) * 2 + (forceSystemValue ? 1 : 0)) * 2 + (maximized ? 1 : 0);
+}
+
+static ScreenMetrics &screenMetrics(SystemMetricCacheData *data, QScreen *screen)
+{
+    auto it = data->screens.find(screen);
+    if (it != data->screens.end()) {
+        return it.value();
+    }
+
+    it = data->screens.insert(screen, {});
+    it->reset();
+    if (screen) {
+        // The screen is half destroyed, only its address is used.
+        QObject::connect(screen, &QObject::destroyed, &data->context, [screen](){
+            if (SystemMetricCacheData *d = g_systemMetricCacheData()) {
+                d->screens.remove(screen);
+            }
+        });
+        const auto invalidateScreen = [screen](){
+            SystemMetricCache::invalidate(screen);
+        };
+        QObject::connect(screen, &QScreen::logicalDotsPerInchChanged, &data->context, invalidateScreen);
+        QObject::connect(screen, &QScreen::physicalDotsPerInchChanged, &data->context, invalidateScreen);
+    }
+    return it.value();
+}
+
+int SystemMetricCache::getSystemMetric(const QWindow *window, const SystemMetric metric, const bool dpiScale, const bool forceSystemValue)
+{
+    Q_ASSERT(window);
+    if (!window) {
+        return 0;
+    }
+    SystemMetricCacheData *data = g_systemMetricCacheData();
+    if (!data) {
+        return Utilities::getSystemMetric(window, metric, dpiScale, forceSystemValue);
+    }
+
+    ScreenMetrics &metrics = screenMetrics(data, window->screen());
+    // Not every DPR change is announced, e.g. a new QT_SCALE_FACTOR.
+    const qreal devicePixelRatio = window->devicePixelRatio();
+    if (!qFuzzyCompare(metrics.devicePixelRatio, devicePixelRatio)) {
+        metrics.reset();
+        metrics.devicePixelRatio = devicePixelRatio;
+    }
+
+    // Only the title bar height depends on the window state.
+    const Qt::WindowStates states = window->windowState();
+    const bool maximized = (metric == SystemMetric::TitleBarHeight)
+            && ((states & Qt::WindowMaximized) || (states & Qt::WindowFullScreen));
+    int &value = metrics.values[metricSlot(metric, dpiScale, forceSystemValue, maximized)];
+    if (value < 0) {
+        value = Utilities::getSystemMetric(window, metric, dpiScale, forceSystemValue);
+    }
+    return value;
+}
+
+void SystemMetricCache::invalidate()
+{
+    SystemMetricCacheData *data = g_systemMetricCacheData();
+    if (!data) {
+        return;
+    }
+    for (auto it = data->screens.begin(); it != data->screens.end(); ++it) {
+        it->reset();
+    }
+    Q_EMIT data->notifier.invalidated();
+}
+
+void SystemMetricCache::invalidate(const QScreen *screen)
+{
+    SystemMetricCacheData *data = g_systemMetricCacheData();
+    if (!data) {
+        return;
+    }
+    const auto it = data->screens.find(screen);
+    if (it != data->screens.end()) {
+        it->reset();
+    }
+    Q_EMIT data->notifier.invalidated();
+}
+
+SystemMetricNotifier *SystemMetricCache::notifier()
+{
+    SystemMetricCacheData *data = g_systemMetricCacheData();
+    return data ? &data->notifier : nullptr;
+}
+
+FRAMELESSHELPER_END_NAMESPACE
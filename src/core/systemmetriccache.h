@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qobject.h>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QWindow)
+QT_FORWARD_DECLARE_CLASS(QScreen)
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    Announces SystemMetricCache invalidations, so whatever was computed from
+    the cached metrics can be dropped as well.
+ */
+class FRAMELESSHELPER_API SystemMetricNotifier : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(SystemMetricNotifier)
+
+public:
+    explicit SystemMetricNotifier(QObject *parent = nullptr) : QObject(parent) {}
+    ~SystemMetricNotifier() override = default;
+
+Q_SIGNALS:
+    void invalidated();
+};
+
+/*!
+    Caches Utilities::getSystemMetric() per screen, device pixel ratio and
+    window state, which is all the metrics depend on. A window moving to
+    another screen or changing its state just selects another entry; the
+    entries of a screen are dropped when its DPI changes or it goes away,
+    and all of them on theme and system setting changes.
+ */
+namespace SystemMetricCache
+{
+
+FRAMELESSHELPER_API int getSystemMetric(const QWindow *window, const SystemMetric metric, const bool dpiScale, const bool forceSystemValue = false);
+
+FRAMELESSHELPER_API void invalidate();
+FRAMELESSHELPER_API void invalidate(const QScreen *screen);
+
+// Emits invalidated() after every invalidation, nullptr at shutdown.
+FRAMELESSHELPER_API SystemMetricNotifier *notifier();
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
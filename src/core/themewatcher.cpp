@@ -0,0 +1,215 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "themewatcher.h"
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qstandardpaths.h>
+#ifdef FRAMELESSHELPER_HAS_X11
+#include "xsettings.h"
+#endif
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+Q_GLOBAL_STATIC(ThemeWatcher, g_themeWatcher)
+
+static QString configPath(const QString &fileName)
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) + QLatin1Char('/') + fileName;
+}
+
+static QString gtkSettingsPath()
+{
+    return configPath(QStringLiteral("gtk-3.0/settings.ini"));
+}
+
+static QString kdeGlobalsPath()
+{
+    return configPath(QStringLiteral("kdeglobals"));
+}
+
+static QString dconfPath()
+{
+    return configPath(QStringLiteral("dconf/user"));
+}
+
+/*!
+    The keys of an INI style file as "group/key". Enough for settings.ini
+    and kdeglobals, QSettings would split the color values into lists.
+ */
+static QHash<QString, QString> readIniFile(const QString &fileName)
+{
+    QHash<QString, QString> values;
+    QFile file(fileName);
+    if (!file.open(QFile::ReadOnly | QFile::Text)) {
+        return values;
+    }
+    QString group;
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')) || line.startsWith(QLatin1Char(';'))) {
+            continue;
+        }
+        if (line.startsWith(QLatin1Char('[')) && line.endsWith(QLatin1Char(']'))) {
+            group = line.mid(1, line.size() - 2);
+            continue;
+        }
+        const int separator = line.indexOf(QLatin1Char('='));
+        if (separator <= 0) {
+            continue;
+        }
+        values.insert(group + QLatin1Char('/') + line.left(separator).trimmed(), line.mid(separator + 1).trimmed());
+    }
+    return values;
+}
+
+// KDE writes colors as "r,g,b".
+static QColor parseKdeColor(const QString &value)
+{
+    const QStringList parts = value.split(QLatin1Char(','));
+    if (parts.size() < 3) {
+        return {};
+    }
+    bool okR = false, okG = false, okB = false;
+    const QColor color(parts.at(0).toInt(&okR), parts.at(1).toInt(&okG), parts.at(2).toInt(&okB));
+    return (okR && okG && okB) ? color : QColor();
+}
+
+static bool isKdeSession()
+{
+    return qEnvironmentVariable("XDG_CURRENT_DESKTOP").contains(QStringLiteral("KDE"), Qt::CaseInsensitive);
+}
+
+ThemeWatcher::ThemeWatcher(QObject *parent) : QObject(parent)
+{
+    m_updateTimer.setSingleShot(true);
+    m_updateTimer.setInterval(100);
+    connect(&m_updateTimer, &QTimer::timeout, this, &ThemeWatcher::update);
+    connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &ThemeWatcher::scheduleUpdate);
+    connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &ThemeWatcher::scheduleUpdate);
+#ifdef FRAMELESSHELPER_HAS_X11
+    if (XSettings *settings = XSettings::instance()) {
+        connect(settings, &XSettings::settingsChanged, this, &ThemeWatcher::scheduleUpdate);
+    }
+#endif
+
+    update();
+}
+
+ThemeWatcher *ThemeWatcher::instance()
+{
+    return g_themeWatcher();
+}
+
+void ThemeWatcher::scheduleUpdate()
+{
+    if (!m_updateTimer.isActive()) {
+        m_updateTimer.start();
+    }
+}
+
+/*!
+    Files replaced by a rename drop out of the watcher, their directories
+    are watched as well to notice them coming back.
+ */
+void ThemeWatcher::updateWatchedPaths()
+{
+    QStringList paths;
+    for (const QString &fileName : {gtkSettingsPath(), kdeGlobalsPath(), dconfPath()}) {
+        const QFileInfo info(fileName);
+        if (info.exists()) {
+            paths.append(fileName);
+        }
+        if (info.dir().exists()) {
+            paths.append(info.absolutePath());
+        }
+    }
+    paths.removeDuplicates();
+
+    const QStringList watched = m_watcher.files() + m_watcher.directories();
+    QStringList added;
+    for (const QString &path : qAsConst(paths)) {
+        if (!watched.contains(path)) {
+            added.append(path);
+        }
+    }
+    if (!added.isEmpty()) {
+        m_watcher.addPaths(added);
+    }
+}
+
+void ThemeWatcher::update()
+{
+    updateWatchedPaths();
+
+    const QHash<QString, QString> gtk = readIniFile(gtkSettingsPath());
+    const QHash<QString, QString> kde = isKdeSession() ? readIniFile(kdeGlobalsPath()) : QHash<QString, QString>();
+
+    QString themeName;
+#ifdef FRAMELESSHELPER_HAS_X11
+    if (const XSettings *settings = XSettings::instance()) {
+        themeName = QString::fromUtf8(settings->value(QByteArrayLiteral("Net/ThemeName")).toByteArray());
+    }
+#endif
+    if (themeName.isEmpty()) {
+        themeName = gtk.value(QStringLiteral("Settings/gtk-theme-name"));
+    }
+    if (themeName.isEmpty()) {
+        themeName = kde.value(QStringLiteral("General/ColorScheme"));
+    }
+
+    bool darkMode = themeName.contains(QStringLiteral("dark"), Qt::CaseInsensitive);
+    const QString preferDark = gtk.value(QStringLiteral("Settings/gtk-application-prefer-dark-theme"));
+    if (preferDark == QStringLiteral("1") || preferDark.compare(QStringLiteral("true"), Qt::CaseInsensitive) == 0) {
+        darkMode = true;
+    }
+    const QColor windowColor = parseKdeColor(kde.value(QStringLiteral("Colors:Window/BackgroundNormal")));
+    if (windowColor.isValid()) {
+        darkMode = windowColor.lightness() < 128;
+    }
+
+    QColor colorizationColor = parseKdeColor(kde.value(QStringLiteral("General/AccentColor")));
+    if (!colorizationColor.isValid()) {
+        colorizationColor = parseKdeColor(kde.value(QStringLiteral("WM/activeBackground")));
+    }
+    const ColorizationArea colorizationArea = colorizationColor.isValid()
+            ? ColorizationArea::TitleBar_WindowBorder : ColorizationArea::NoArea;
+    if (!colorizationColor.isValid()) {
+        colorizationColor = Qt::darkGray;
+    }
+
+    if ((darkMode == m_darkMode) && (colorizationColor == m_colorizationColor)
+            && (colorizationArea == m_colorizationArea) && (themeName == m_themeName)) {
+        return;
+    }
+    m_darkMode = darkMode;
+    m_colorizationColor = colorizationColor;
+    m_colorizationArea = colorizationArea;
+    m_themeName = themeName;
+    Q_EMIT themeChanged();
+}
+
+FRAMELESSHELPER_END_NAMESPACE
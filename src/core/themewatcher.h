@@ -0,0 +1,79 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qobject.h>
+#include <QtCore/qfilesystemwatcher.h>
+#include <QtCore/qtimer.h>
+#include <QtGui/qcolor.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    Follows the desktop theme on Linux: the XSETTINGS Net/ThemeName, the
+    GTK 3 settings.ini, KDE's kdeglobals and the dconf database (only as a
+    change trigger, the GTK settings daemon mirrors it to the XSETTINGS).
+
+    The values are cached and the getters don't touch the system.
+    themeChanged() is emitted when one of them actually changed, so the
+    theme doesn't need to be polled.
+ */
+class FRAMELESSHELPER_API ThemeWatcher : public QObject
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(ThemeWatcher)
+
+public:
+    explicit ThemeWatcher(QObject *parent = nullptr);
+    ~ThemeWatcher() override = default;
+
+    static ThemeWatcher *instance();
+
+    bool isDarkMode() const { return m_darkMode; }
+    QColor colorizationColor() const { return m_colorizationColor; }
+    ColorizationArea colorizationArea() const { return m_colorizationArea; }
+    QString themeName() const { return m_themeName; }
+
+Q_SIGNALS:
+    void themeChanged();
+
+private Q_SLOTS:
+    void scheduleUpdate();
+    void update();
+
+private:
+    void updateWatchedPaths();
+
+    bool m_darkMode = false;
+    QColor m_colorizationColor = Qt::darkGray;
+    ColorizationArea m_colorizationArea = ColorizationArea::NoArea;
+    QString m_themeName;
+    QFileSystemWatcher m_watcher;
+    // Settings are usually written as a burst of file events.
+    QTimer m_updateTimer;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -23,6 +23,9 @@
  */
 
 #include "utilities.h"
+#include "objectgeometry.h"
+#include "hittestvisibleregistry.h"
+#include "windowstateregistry.h"
 #include <QtCore/qdebug.h>
 #include <QtCore/qvariant.h>
 #include <QtGui/qguiapplication.h>
@@ -35,6 +38,10 @@ QWindow *Utilities::findWindow(const WId winId)
     if (!winId) {
         return nullptr;
     }
+    // The frameless windows, which are the ones asked for most of the time.
+    if (QWindow *window = WindowStateRegistry::findWindow(winId)) {
+        return window;
+    }
     const QWindowList windows = QGuiApplication::topLevelWindows();
     if (windows.isEmpty()) {
         return nullptr;
@@ -74,22 +81,16 @@ bool Utilities::isHitTestVisible(const QWindow *window)
     if (!window) {
         return false;
     }
-    const auto objs = qvariant_cast<QObjectList>(window->property(Constants::kHitTestVisibleFlag));
-    if (objs.isEmpty()) {
+    const ObjectRegistry<HitTestVisibleRegistry::Entry> *objs = HitTestVisibleRegistry::objects(window);
+    if (!objs || objs->isEmpty()) {
         return false;
     }
-    for (auto &&obj : qAsConst(objs)) {
-        if (!obj || !(obj->isWidgetType() || obj->inherits("QQuickItem"))) {
-            continue;
-        }
-        if (!obj->property("visible").toBool()) {
+    const QPoint pos = window->mapFromGlobal(QCursor::pos(window->screen()));
+    for (const HitTestVisibleRegistry::Entry &entry : *objs) {
+        if (!ObjectGeometry::isVisible(entry.object, entry.kind)) {
             continue;
         }
-        const QPointF originPoint = mapOriginPointToWindow(obj);
-        const qreal width = obj->property("width").toReal();
-        const qreal height = obj->property("height").toReal();
-        const QRectF rect = {originPoint.x(), originPoint.y(), width, height};
-        if (rect.contains(QCursor::pos(window->screen()))) {
+        if (ObjectGeometry::windowRect(entry.object, entry.kind).contains(pos)) {
             return true;
         }
     }
@@ -102,18 +103,13 @@ QPointF Utilities::mapOriginPointToWindow(const QObject *object)
     if (!object) {
         return {};
     }
-    if (!object->isWidgetType() && !object->inherits("QQuickItem")) {
+    const ObjectKind kind = ObjectGeometry::kindOf(object);
+    if (kind == ObjectKind::Unknown) {
         qWarning() << object << "is not a QWidget or a QQuickItem.";
         return {};
     }
-    QPointF point = {object->property("x").toReal(), object->property("y").toReal()};
-    for (QObject *parent = object->parent(); parent; parent = parent->parent()) {
-        point += {parent->property("x").toReal(), parent->property("y").toReal()};
-        if (parent->isWindowType()) {
-            break;
-        }
-    }
-    return point;
+    // The origin of the window itself is included, so this is in global coordinates.
+    return ObjectGeometry::globalPos(object, kind);
 }
 
 FRAMELESSHELPER_END_NAMESPACE
@@ -65,6 +65,7 @@ FRAMELESSHELPER_API void startX11Resizing(QWindow *w, const QPoint &globalPos, Q
 FRAMELESSHELPER_API void setX11CursorShape(QWindow *w, int cursorId);
 FRAMELESSHELPER_API void resetX1CursorShape(QWindow *w);
 FRAMELESSHELPER_API unsigned int getX11CursorForFrameSection(Qt::WindowFrameSection frameSection);
+FRAMELESSHELPER_API void selectX11Events(const quint32 window, const quint32 eventMask);
 #endif // Q_OS_LINUX
 
 #ifdef Q_OS_MAC
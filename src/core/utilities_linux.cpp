@@ -23,12 +23,19 @@
  */
 
 #include "utilities.h"
+#include "themewatcher.h"
 
 #include <QtCore/qvariant.h>
 #include <QtCore/qdebug.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qlibrary.h>
 #include <QtGui/qscreen.h>
+#ifdef FRAMELESSHELPER_HAS_X11
 #include <QtX11Extras/qx11info_x11.h>
 #include <X11/Xlib.h>
+#include <xcb/xcb.h>
+#include "xsettings.h"
+#endif
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
@@ -48,6 +55,23 @@ FRAMELESSHELPER_BEGIN_NAMESPACE
 static constexpr int kDefaultResizeBorderThickness = 8;
 static constexpr int kDefaultCaptionHeight = 23;
 
+/*!
+    How much larger the desktop renders text than the window scaling alone
+    would, from Xft/DPI. The caption height follows the title font.
+ */
+static qreal textScaleFactor()
+{
+#ifdef FRAMELESSHELPER_HAS_X11
+    const XSettings *settings = XSettings::instance();
+    if (settings && settings->xftDpi() > 0) {
+        // Xft/DPI is in 1/1024 DPI and includes Gdk/WindowScalingFactor,
+        // which reaches us through the device pixel ratio instead.
+        return qreal(settings->xftDpi()) / 1024.0 / (96.0 * settings->windowScalingFactor());
+    }
+#endif
+    return 1.0;
+}
+
 int Utilities::getSystemMetric(const QWindow *window, const SystemMetric metric, const bool dpiScale, const bool forceSystemValue)
 {
     Q_ASSERT(window);
@@ -58,7 +82,7 @@ int Utilities::getSystemMetric(const QWindow *window, const SystemMetric metric,
     const qreal scaleFactor = (dpiScale ? devicePixelRatio : 1.0);
     switch (metric) {
     case SystemMetric::ResizeBorderThickness: {
-        // ### TO BE IMPLEMENTED: Retrieve system value through official API
+        // Not part of the XSETTINGS, the themes draw it themselves.
         if (dpiScale) {
             return qRound(static_cast<qreal>(kDefaultResizeBorderThickness) * devicePixelRatio);
         } else {
@@ -67,11 +91,11 @@ int Utilities::getSystemMetric(const QWindow *window, const SystemMetric metric,
 
     }
     case SystemMetric::CaptionHeight: {
-        // ### TO BE IMPLEMENTED: Retrieve system value through official API
+        const qreal captionHeight = static_cast<qreal>(kDefaultCaptionHeight) * textScaleFactor();
         if (dpiScale) {
-            return qRound(static_cast<qreal>(kDefaultCaptionHeight) * devicePixelRatio);
+            return qRound(captionHeight * devicePixelRatio);
         } else {
-            return kDefaultCaptionHeight;
+            return qRound(captionHeight);
         }
     }
     case SystemMetric::TitleBarHeight: {
@@ -89,8 +113,8 @@ int Utilities::getSystemMetric(const QWindow *window, const SystemMetric metric,
 
 QColor Utilities::getColorizationColor()
 {
-    // ### TO BE IMPLEMENTED
-    return Qt::darkGray;
+    const ThemeWatcher *watcher = ThemeWatcher::instance();
+    return watcher ? watcher->colorizationColor() : QColor(Qt::darkGray);
 }
 
 int Utilities::getWindowVisibleFrameBorderThickness(const WId winId)
@@ -102,19 +126,20 @@ int Utilities::getWindowVisibleFrameBorderThickness(const WId winId)
 
 bool Utilities::shouldAppsUseDarkMode()
 {
-    // ### TO BE IMPLEMENTED
-    return false;
+    const ThemeWatcher *watcher = ThemeWatcher::instance();
+    return watcher && watcher->isDarkMode();
 }
 
 ColorizationArea Utilities::getColorizationArea()
 {
-    // ### TO BE IMPLEMENTED
-    return ColorizationArea::NoArea;
+    const ThemeWatcher *watcher = ThemeWatcher::instance();
+    return watcher ? watcher->colorizationArea() : ColorizationArea::NoArea;
 }
 
 bool Utilities::isThemeChanged(const void *data)
 {
-    // ### TO BE IMPLEMENTED
+    // Theme changes don't arrive as window events here, they are reported
+    // by ThemeWatcher::themeChanged().
     Q_UNUSED(data);
     return false;
 }
@@ -135,6 +160,7 @@ bool Utilities::showSystemMenu(const WId winId, const QPointF &pos)
     return false;
 }
 
+#ifdef FRAMELESSHELPER_HAS_X11
 void Utilities::sendX11ButtonReleaseEvent(QWindow *w, const QPoint &globalPos)
 {
     const QPoint pos = w->mapFromGlobal(globalPos);
@@ -249,13 +275,119 @@ enum class X11CursorType
 	kTopLeft = 134,
 };
 
+/*!
+    Name of the cursor in the Xcursor themes matching a font cursor.
+ */
+static const char *x11CursorThemeName(const unsigned int cursorId)
+{
+    switch (static_cast<X11CursorType>(cursorId))
+    {
+    case X11CursorType::kArrow:
+        return "left_ptr";
+    case X11CursorType::kTop:
+        return "top_side";
+    case X11CursorType::kTopRight:
+        return "top_right_corner";
+    case X11CursorType::kRight:
+        return "right_side";
+    case X11CursorType::kBottomRight:
+        return "bottom_right_corner";
+    case X11CursorType::kBottom:
+        return "bottom_side";
+    case X11CursorType::kBottomLeft:
+        return "bottom_left_corner";
+    case X11CursorType::kLeft:
+        return "left_side";
+    case X11CursorType::kTopLeft:
+        return "top_left_corner";
+    }
+    return nullptr;
+}
+
+using XcursorLibraryLoadCursorPtr = Cursor (*)(Display *, const char *);
+using XcursorGetThemePtr = char *(*)(Display *);
+using XcursorGetDefaultSizePtr = int (*)(Display *);
+
+struct X11CursorCache
+{
+    QByteArray theme;
+    int size = 0;
+    QHash<unsigned int, Cursor> cursors;
+};
+
+struct X11CursorData
+{
+    X11CursorData()
+    {
+        // libXcursor is optional, the headers are not needed either.
+        QLibrary xcursor(QStringLiteral("Xcursor"), 1);
+        if (xcursor.load()) {
+            loadCursor = reinterpret_cast<XcursorLibraryLoadCursorPtr>(xcursor.resolve("XcursorLibraryLoadCursor"));
+            getTheme = reinterpret_cast<XcursorGetThemePtr>(xcursor.resolve("XcursorGetTheme"));
+            getDefaultSize = reinterpret_cast<XcursorGetDefaultSizePtr>(xcursor.resolve("XcursorGetDefaultSize"));
+        }
+    }
+
+    XcursorLibraryLoadCursorPtr loadCursor = nullptr;
+    XcursorGetThemePtr getTheme = nullptr;
+    XcursorGetDefaultSizePtr getDefaultSize = nullptr;
+    QHash<Display *, X11CursorCache> displays;
+};
+
+Q_GLOBAL_STATIC(X11CursorData, g_x11CursorData)
+
+/*!
+    Cursors are created once per display, theme and size, instead of on
+    every hover update. Themed cursors are preferred, the cursor font is
+    the fallback.
+ */
+static Cursor getX11Cursor(Display *display, const unsigned int cursorId)
+{
+    X11CursorData *data = g_x11CursorData();
+    if (!data) {
+        return XCreateFontCursor(display, cursorId);
+    }
+    X11CursorCache &cache = data->displays[display];
+
+    // Both are read from the client side resources, no round trip involved.
+    const QByteArray theme = data->getTheme ? QByteArray(data->getTheme(display)) : QByteArray();
+    const int size = data->getDefaultSize ? data->getDefaultSize(display) : 0;
+    if (theme != cache.theme || size != cache.size) {
+        for (const Cursor cursor : qAsConst(cache.cursors)) {
+            XFreeCursor(display, cursor);
+        }
+        cache.cursors.clear();
+        cache.theme = theme;
+        cache.size = size;
+    }
+
+    const auto it = cache.cursors.constFind(cursorId);
+    if (it != cache.cursors.constEnd()) {
+        return it.value();
+    }
+
+    Cursor cursor = None;
+    const char *name = x11CursorThemeName(cursorId);
+    if (data->loadCursor && name) {
+        cursor = data->loadCursor(display, name);
+    }
+    if (cursor == None) {
+        cursor = XCreateFontCursor(display, cursorId);
+    }
+    if (cursor != None) {
+        cache.cursors.insert(cursorId, cursor);
+    }
+    return cursor;
+}
+
 void Utilities::setX11CursorShape(QWindow *w, int cursorId)
 {
 	const auto display = QX11Info::display();
 	const WId window_id = w->winId();
-	const Cursor cursor = XCreateFontCursor(display, cursorId);
+	const Cursor cursor = getX11Cursor(display, cursorId);
 	if (!cursor) {
 		qWarning() << "Failed to set cursor.";
+		return;
 	}
 	XDefineCursor(display, window_id, cursor);
 	XFlush(display);
@@ -309,4 +441,27 @@ unsigned int Utilities::getX11CursorForFrameSection(Qt::WindowFrameSection frame
     return (unsigned int)cursor;
 }
 
+/*!
+    Add \a eventMask to the events selected on \a window. The xcb connection
+    is shared with Qt, which may have selected other events on it already,
+    so they are kept. Costs a round trip.
+ */
+void Utilities::selectX11Events(const quint32 window, const quint32 eventMask)
+{
+    xcb_connection_t *connection = QX11Info::connection();
+    xcb_get_window_attributes_reply_t *reply = xcb_get_window_attributes_reply(
+        connection, xcb_get_window_attributes(connection, window), nullptr);
+    if (!reply) {
+        // The window is gone already.
+        return;
+    }
+    const uint32_t mask = reply->your_event_mask | eventMask;
+    if (mask != reply->your_event_mask) {
+        xcb_change_window_attributes(connection, window, XCB_CW_EVENT_MASK, &mask);
+    }
+    free(reply);
+}
+
+#endif // FRAMELESSHELPER_HAS_X11
+
 FRAMELESSHELPER_END_NAMESPACE
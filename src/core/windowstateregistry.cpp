@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "windowstateregistry.h"
+#include <QtCore/qhash.h>
+#include <QtGui/qevent.h>
+#include <QtGui/qwindow.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+// Follows the creation and destruction of the platform windows.
+class PlatformSurfaceFilter : public QObject
+{
+protected:
+    bool eventFilter(QObject *object, QEvent *event) override;
+};
+
+struct WindowStateRegistryData
+{
+    // Receiver of all the destroyed() connections, they go away with it.
+    PlatformSurfaceFilter context;
+    QHash<const QWindow *, WindowStateRegistry::State> windows;
+    QHash<WId, QWindow *> winIds;
+};
+
+Q_GLOBAL_STATIC(WindowStateRegistryData, g_windowStateRegistryData)
+
+static void updateWinId(WindowStateRegistryData *data, QWindow *window, const WId winId)
+{
+    const auto it = data->windows.find(window);
+    if (it == data->windows.end() || it->winId == winId) {
+        return;
+    }
+    if (it->winId) {
+        data->winIds.remove(it->winId);
+    }
+    it->winId = winId;
+    if (winId) {
+        data->winIds.insert(winId, window);
+    }
+}
+
+bool PlatformSurfaceFilter::eventFilter(QObject *object, QEvent *event)
+{
+    if (event->type() != QEvent::PlatformSurface) {
+        return false;
+    }
+    WindowStateRegistryData *data = g_windowStateRegistryData();
+    if (!data) {
+        return false;
+    }
+    const auto window = static_cast<QWindow *>(object);
+    const auto ev = static_cast<QPlatformSurfaceEvent *>(event);
+    if (ev->surfaceEventType() == QPlatformSurfaceEvent::SurfaceCreated) {
+        updateWinId(data, window, window->winId());
+    } else {
+        updateWinId(data, window, 0);
+    }
+    return false;
+}
+
+const WindowStateRegistry::State *WindowStateRegistry::find(const QWindow *window)
+{
+    WindowStateRegistryData *data = g_windowStateRegistryData();
+    if (!window || !data) {
+        return nullptr;
+    }
+    const auto it = data->windows.constFind(window);
+    return it == data->windows.constEnd() ? nullptr : &it.value();
+}
+
+WindowStateRegistry::State *WindowStateRegistry::ensure(QWindow *window)
+{
+    Q_ASSERT(window);
+    WindowStateRegistryData *data = g_windowStateRegistryData();
+    if (!window || !data) {
+        return nullptr;
+    }
+    auto it = data->windows.find(window);
+    if (it == data->windows.end()) {
+        it = data->windows.insert(window, {});
+        // The window is half destroyed, only its address is used.
+        QObject::connect(window, &QObject::destroyed, &data->context, [window](){
+            if (WindowStateRegistryData *d = g_windowStateRegistryData()) {
+                const auto state = d->windows.find(window);
+                if (state != d->windows.end()) {
+                    if (state->winId) {
+                        d->winIds.remove(state->winId);
+                    }
+                    d->windows.erase(state);
+                }
+            }
+        });
+        window->installEventFilter(&data->context);
+        if (window->handle()) {
+            it->winId = window->winId();
+            data->winIds.insert(it->winId, window);
+        }
+    }
+    return &it.value();
+}
+
+QWindow *WindowStateRegistry::findWindow(const WId winId)
+{
+    WindowStateRegistryData *data = g_windowStateRegistryData();
+    if (!winId || !data) {
+        return nullptr;
+    }
+    return data->winIds.value(winId, nullptr);
+}
+
+QVector<QWindow *> WindowStateRegistry::windowsSharing(const FramelessProfile &profile)
+{
+    QVector<QWindow *> windows;
+    WindowStateRegistryData *data = g_windowStateRegistryData();
+    if (!data) {
+        return windows;
+    }
+    for (auto it = data->windows.cbegin(); it != data->windows.cend(); ++it) {
+        if (it->profile.isSharedWith(profile)) {
+            windows.append(const_cast<QWindow *>(it.key()));
+        }
+    }
+    return windows;
+}
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,73 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include "framelessprofile.h"
+#include <QtCore/qvector.h>
+#include <QtGui/qwindowdefs.h>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QWindow)
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    The per window settings of FramelessWindowsManager, as plain members
+    instead of dynamic properties. A window's state is created when it is
+    added or first configured, and dropped together with the window.
+
+    The windows are also indexed by their native handle, kept up to date
+    as their platform windows are created and destroyed, so a native
+    event is mapped to its window (or rejected) with one hash lookup.
+ */
+namespace WindowStateRegistry
+{
+
+struct State
+{
+    bool frameless = false;
+    // Shared with the other windows configured alike.
+    FramelessProfile profile;
+    // 0 while there is no platform window.
+    WId winId = 0;
+    // Qt::MSWindowsFixedSizeDialogHint was set for the profile, and not by
+    // the application, so it may be cleared again.
+    bool fixedSizeHintSet = false;
+};
+
+// nullptr if the window has no state. Valid until the next ensure().
+const State *find(const QWindow *window);
+State *ensure(QWindow *window);
+
+// nullptr if the window of the handle has no state.
+QWindow *findWindow(const WId winId);
+
+QVector<QWindow *> windowsSharing(const FramelessProfile &profile);
+
+}
+
+FRAMELESSHELPER_END_NAMESPACE
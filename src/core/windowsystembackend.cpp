@@ -0,0 +1,661 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "windowsystembackend.h"
+#include "utilities.h"
+#include "clientsidemoveresize.h"
+#include <QtCore/qdebug.h>
+#include <QtCore/qscopedpointer.h>
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qwindow.h>
+#ifdef FRAMELESSHELPER_HAS_X11
+#include <QtCore/qabstractnativeeventfilter.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qhash.h>
+#include <QtGui/qscreen.h>
+#include <QtX11Extras/qx11info_x11.h>
+#include <xcb/xcb.h>
+#include <cstdlib>
+#include <cstring>
+#endif
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+#ifdef FRAMELESSHELPER_HAS_X11
+class XlibWindowSystemBackend : public WindowSystemBackend
+{
+public:
+    QString name() const override
+    {
+        return QStringLiteral("xlib");
+    }
+
+    void startMove(QWindow *window, const QPoint &globalPos) override
+    {
+        Utilities::sendX11ButtonReleaseEvent(window, globalPos);
+        Utilities::startX11Moving(window, globalPos);
+    }
+
+    void startResize(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection) override
+    {
+        Utilities::sendX11ButtonReleaseEvent(window, globalPos);
+        Utilities::startX11Resizing(window, globalPos, frameSection);
+    }
+
+    void setResizeCursor(QWindow *window, const Qt::WindowFrameSection frameSection) override
+    {
+        Utilities::setX11CursorShape(window, Utilities::getX11CursorForFrameSection(frameSection));
+    }
+
+    void unsetResizeCursor(QWindow *window) override
+    {
+        Utilities::resetX1CursorShape(window);
+    }
+};
+
+/*!
+    Talks to the X server through xcb without ever waiting for it: the
+    atoms are interned once, all of them in one batch, and a drag start is
+    a synthetic button release, a pointer ungrab and a _NET_WM_MOVERESIZE
+    message sent with a single flush. The scale factor of each QScreen is
+    cached. All of them are parts of the same X screen, so there is a
+    single root window, looked up once.
+
+    The cursors are shared with the Xlib backend.
+
+    Resizes through the window manager are throttled to the repaints by
+    _NET_WM_SYNC_REQUEST, which the xcb platform plugin already implements:
+    it advertises the protocol, owns the counter and updates it once the
+    frame is flushed. A second counter from here would fight with it, so
+    nothing of it is done here.
+ */
+class XcbWindowSystemBackend : public XlibWindowSystemBackend, public QAbstractNativeEventFilter
+{
+public:
+    XcbWindowSystemBackend()
+        : m_connection(QX11Info::connection())
+        , m_root(xcb_window_t(QX11Info::appRootWindow(QX11Info::appScreen())))
+    {
+        static const char *const atomNames[AtomCount] = {
+            "_NET_WM_MOVERESIZE",
+            "_NET_SUPPORTED",
+            "_NET_SUPPORTING_WM_CHECK"
+        };
+
+        // Send all the requests first, then collect the replies, so the
+        // whole batch costs one round trip.
+        xcb_intern_atom_cookie_t cookies[AtomCount];
+        for (int i = 0; i < AtomCount; ++i) {
+            cookies[i] = xcb_intern_atom(m_connection, false, uint16_t(strlen(atomNames[i])), atomNames[i]);
+        }
+        for (int i = 0; i < AtomCount; ++i) {
+            xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(m_connection, cookies[i], nullptr);
+            m_atoms[i] = reply ? reply->atom : xcb_atom_t(XCB_ATOM_NONE);
+            free(reply);
+        }
+
+        // A window manager starting, or replacing the running one, updates
+        // these root window properties. The filter goes away with us.
+        Utilities::selectX11Events(m_root, XCB_EVENT_MASK_PROPERTY_CHANGE);
+        if (QCoreApplication *app = QCoreApplication::instance()) {
+            app->installNativeEventFilter(this);
+        }
+    }
+
+    QString name() const override
+    {
+        return QStringLiteral("xcb");
+    }
+
+    void startMove(QWindow *window, const QPoint &globalPos) override
+    {
+        if (!isMoveResizeSupported()) {
+            m_clientSide.startMove(window, globalPos);
+            return;
+        }
+        sendMoveResize(window, globalPos, _NET_WM_MOVERESIZE_MOVE);
+    }
+
+    void startResize(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection) override
+    {
+        if (!isMoveResizeSupported()) {
+            m_clientSide.startResize(window, globalPos, frameSection);
+            return;
+        }
+        const int action = moveResizeAction(frameSection);
+        if (action >= 0) {
+            sendMoveResize(window, globalPos, action);
+        }
+    }
+
+private:
+    enum Atom
+    {
+        NetWmMoveResize = 0,
+        NetSupported,
+        NetSupportingWmCheck,
+        AtomCount
+    };
+
+    enum
+    {
+        _NET_WM_MOVERESIZE_SIZE_TOPLEFT = 0,
+        _NET_WM_MOVERESIZE_SIZE_TOP,
+        _NET_WM_MOVERESIZE_SIZE_TOPRIGHT,
+        _NET_WM_MOVERESIZE_SIZE_RIGHT,
+        _NET_WM_MOVERESIZE_SIZE_BOTTOMRIGHT,
+        _NET_WM_MOVERESIZE_SIZE_BOTTOM,
+        _NET_WM_MOVERESIZE_SIZE_BOTTOMLEFT,
+        _NET_WM_MOVERESIZE_SIZE_LEFT,
+        _NET_WM_MOVERESIZE_MOVE
+    };
+
+    // Only the scaling differs between the screens.
+    struct ScreenData
+    {
+        qreal devicePixelRatio = 1.0;
+    };
+
+    static int moveResizeAction(const Qt::WindowFrameSection frameSection)
+    {
+        switch (frameSection)
+        {
+        case Qt::LeftSection:
+            return _NET_WM_MOVERESIZE_SIZE_LEFT;
+        case Qt::TopLeftSection:
+            return _NET_WM_MOVERESIZE_SIZE_TOPLEFT;
+        case Qt::TopSection:
+            return _NET_WM_MOVERESIZE_SIZE_TOP;
+        case Qt::TopRightSection:
+            return _NET_WM_MOVERESIZE_SIZE_TOPRIGHT;
+        case Qt::RightSection:
+            return _NET_WM_MOVERESIZE_SIZE_RIGHT;
+        case Qt::BottomRightSection:
+            return _NET_WM_MOVERESIZE_SIZE_BOTTOMRIGHT;
+        case Qt::BottomSection:
+            return _NET_WM_MOVERESIZE_SIZE_BOTTOM;
+        case Qt::BottomLeftSection:
+            return _NET_WM_MOVERESIZE_SIZE_BOTTOMLEFT;
+        default:
+            break;
+        }
+        return -1;
+    }
+
+    QVector<xcb_atom_t> atomListProperty(const xcb_window_t window, const xcb_atom_t property) const
+    {
+        QVector<xcb_atom_t> atoms;
+        if (property == XCB_ATOM_NONE) {
+            return atoms;
+        }
+        const xcb_get_property_cookie_t cookie = xcb_get_property(m_connection, false, window, property,
+                                                                  XCB_ATOM_ATOM, 0, 4096);
+        xcb_get_property_reply_t *reply = xcb_get_property_reply(m_connection, cookie, nullptr);
+        if (reply && reply->type == XCB_ATOM_ATOM && reply->format == 32) {
+            const auto values = static_cast<const xcb_atom_t *>(xcb_get_property_value(reply));
+            const int count = xcb_get_property_value_length(reply) / int(sizeof(xcb_atom_t));
+            atoms.reserve(count);
+            for (int i = 0; i < count; ++i) {
+                atoms.append(values[i]);
+            }
+        }
+        free(reply);
+        return atoms;
+    }
+
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+    bool nativeEventFilter(const QByteArray &eventType, void *message, qintptr *result) override
+#else
+    bool nativeEventFilter(const QByteArray &eventType, void *message, long *result) override
+#endif
+    {
+        Q_UNUSED(result);
+        if ((eventType != QByteArrayLiteral("xcb_generic_event_t")) || !message) {
+            return false;
+        }
+        const auto event = static_cast<const xcb_generic_event_t *>(message);
+        if ((event->response_type & ~0x80) != XCB_PROPERTY_NOTIFY) {
+            return false;
+        }
+        const auto ev = reinterpret_cast<const xcb_property_notify_event_t *>(event);
+        if (ev->window == m_root
+                && (ev->atom == m_atoms[NetSupported] || ev->atom == m_atoms[NetSupportingWmCheck])) {
+            // Read again on the next drag.
+            m_netSupportedLoaded = false;
+            m_netSupported.clear();
+        }
+        return false;
+    }
+
+    /*!
+        Whether the window manager announces \a atom in _NET_SUPPORTED. The
+        list is read on the first drag after it changed.
+     */
+    bool isNetSupported(const xcb_atom_t atom)
+    {
+        if (!m_netSupportedLoaded) {
+            m_netSupportedLoaded = true;
+            m_netSupported = atomListProperty(m_root, m_atoms[NetSupported]);
+        }
+        return m_netSupported.contains(atom);
+    }
+
+    /*!
+        Without a window manager, or with one which doesn't implement the
+        EWMH, _NET_WM_MOVERESIZE is silently ignored and the window is moved
+        and resized by ClientSideMoveResize instead.
+     */
+    bool isMoveResizeSupported()
+    {
+        const xcb_atom_t moveResize = m_atoms[NetWmMoveResize];
+        return moveResize != XCB_ATOM_NONE && isNetSupported(moveResize);
+    }
+
+    ScreenData screenData(QScreen *screen)
+    {
+        const auto it = m_screens.constFind(screen);
+        if (it != m_screens.constEnd()) {
+            return it.value();
+        }
+
+        ScreenData data;
+        data.devicePixelRatio = screen ? screen->devicePixelRatio() : 1.0;
+        m_screens.insert(screen, data);
+
+        if (screen) {
+            // Drop the entry when the screen goes away or its scaling changes.
+            const auto invalidate = [this, screen](){ m_screens.remove(screen); };
+            QObject::connect(screen, &QObject::destroyed, &m_context, invalidate);
+            QObject::connect(screen, &QScreen::logicalDotsPerInchChanged, &m_context, invalidate);
+            QObject::connect(screen, &QScreen::physicalDotsPerInchChanged, &m_context, invalidate);
+        }
+
+        return data;
+    }
+
+    void sendMoveResize(QWindow *window, const QPoint &globalPos, const int action)
+    {
+        if (m_atoms[NetWmMoveResize] == XCB_ATOM_NONE) {
+            qWarning() << "_NET_WM_MOVERESIZE is not available.";
+            return;
+        }
+
+        const ScreenData screen = screenData(window->screen());
+        const xcb_window_t winId = xcb_window_t(window->winId());
+        const QPoint nativeGlobalPos = globalPos * screen.devicePixelRatio;
+        const QPoint nativePos = window->mapFromGlobal(globalPos) * screen.devicePixelRatio;
+
+        // On HiDPI screens Qt might otherwise still believe the button is
+        // pressed once the window manager took over.
+        xcb_button_release_event_t release;
+        memset(&release, 0, sizeof(release));
+        release.response_type = XCB_BUTTON_RELEASE;
+        release.time = XCB_CURRENT_TIME;
+        release.root = m_root;
+        release.event = winId;
+        release.child = XCB_NONE;
+        release.root_x = int16_t(nativeGlobalPos.x());
+        release.root_y = int16_t(nativeGlobalPos.y());
+        release.event_x = int16_t(nativePos.x());
+        release.event_y = int16_t(nativePos.y());
+        release.same_screen = 1;
+        xcb_send_event(m_connection, true, winId, XCB_EVENT_MASK_BUTTON_RELEASE,
+                       reinterpret_cast<const char *>(&release));
+
+        xcb_ungrab_pointer(m_connection, XCB_CURRENT_TIME);
+
+        xcb_client_message_event_t message;
+        memset(&message, 0, sizeof(message));
+        message.response_type = XCB_CLIENT_MESSAGE;
+        message.format = 32;
+        message.window = winId;
+        message.type = m_atoms[NetWmMoveResize];
+        message.data.data32[0] = uint32_t(nativeGlobalPos.x());
+        message.data.data32[1] = uint32_t(nativeGlobalPos.y());
+        message.data.data32[2] = uint32_t(action);
+        message.data.data32[3] = XCB_BUTTON_INDEX_1;
+        message.data.data32[4] = 0;
+        xcb_send_event(m_connection, false, m_root,
+                       XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY,
+                       reinterpret_cast<const char *>(&message));
+
+        xcb_flush(m_connection);
+    }
+
+    xcb_connection_t *m_connection = nullptr;
+    xcb_window_t m_root = XCB_NONE;
+    xcb_atom_t m_atoms[AtomCount];
+    QHash<QScreen *, ScreenData> m_screens;
+    QVector<xcb_atom_t> m_netSupported;
+    bool m_netSupportedLoaded = false;
+    QObject m_context;
+    ClientSideMoveResize m_clientSide;
+};
+#endif // FRAMELESSHELPER_HAS_X11
+
+#ifdef Q_OS_MAC
+class CocoaWindowSystemBackend : public WindowSystemBackend
+{
+public:
+    QString name() const override
+    {
+        return QStringLiteral("cocoa");
+    }
+
+    void startMove(QWindow *window, const QPoint &globalPos) override
+    {
+        Utilities::startMacDrag(window, globalPos);
+    }
+
+    void startResize(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection) override
+    {
+        // On MacOS, we use native resize handler. So, we do not need to implement
+        // any resize function.
+        Q_UNUSED(window);
+        Q_UNUSED(globalPos);
+        Q_UNUSED(frameSection);
+    }
+};
+#endif // Q_OS_MAC
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
+class QtWindowSystemBackend : public WindowSystemBackend
+{
+public:
+    QString name() const override
+    {
+        return QStringLiteral("qt");
+    }
+
+    void startMove(QWindow *window, const QPoint &globalPos) override
+    {
+        Q_UNUSED(globalPos);
+        if (!window->startSystemMove()) {
+            qWarning() << "The platform doesn't support interactive moves.";
+        }
+    }
+
+    void startResize(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection) override
+    {
+        Q_UNUSED(globalPos);
+        const Qt::Edges edges = edgesForFrameSection(frameSection);
+        if (edges && !window->startSystemResize(edges)) {
+            qWarning() << "The platform doesn't support interactive resizes.";
+        }
+    }
+
+private:
+    static Qt::Edges edgesForFrameSection(const Qt::WindowFrameSection frameSection)
+    {
+        switch (frameSection)
+        {
+        case Qt::LeftSection:
+            return Qt::LeftEdge;
+        case Qt::TopLeftSection:
+            return Qt::TopEdge | Qt::LeftEdge;
+        case Qt::TopSection:
+            return Qt::TopEdge;
+        case Qt::TopRightSection:
+            return Qt::TopEdge | Qt::RightEdge;
+        case Qt::RightSection:
+            return Qt::RightEdge;
+        case Qt::BottomRightSection:
+            return Qt::BottomEdge | Qt::RightEdge;
+        case Qt::BottomSection:
+            return Qt::BottomEdge;
+        case Qt::BottomLeftSection:
+            return Qt::BottomEdge | Qt::LeftEdge;
+        default:
+            break;
+        }
+        return {};
+    }
+};
+#endif
+
+void WindowSystemBackend::setResizeCursor(QWindow *window, const Qt::WindowFrameSection frameSection)
+{
+    window->setCursor(cursorShapeForFrameSection(frameSection));
+}
+
+void WindowSystemBackend::unsetResizeCursor(QWindow *window)
+{
+    window->unsetCursor();
+}
+
+Qt::CursorShape WindowSystemBackend::cursorShapeForFrameSection(const Qt::WindowFrameSection frameSection)
+{
+    switch (frameSection)
+    {
+    case Qt::LeftSection:
+    case Qt::RightSection:
+        return Qt::SizeHorCursor;
+    case Qt::BottomSection:
+    case Qt::TopSection:
+        return Qt::SizeVerCursor;
+    case Qt::TopLeftSection:
+    case Qt::BottomRightSection:
+        return Qt::SizeFDiagCursor;
+    case Qt::TopRightSection:
+    case Qt::BottomLeftSection:
+        return Qt::SizeBDiagCursor;
+    default:
+        break;
+    }
+    return Qt::ArrowCursor;
+}
+
+/*!
+    Moves and resizes the windows itself, see ClientSideMoveResize. The
+    xcb backend falls back to it on its own when no EWMH window manager
+    runs, this one is only used on request.
+ */
+class ClientSideWindowSystemBackend : public WindowSystemBackend
+{
+public:
+    QString name() const override
+    {
+        return QStringLiteral("client");
+    }
+
+    void startMove(QWindow *window, const QPoint &globalPos) override
+    {
+        m_clientSide.startMove(window, globalPos);
+    }
+
+    void startResize(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection) override
+    {
+        m_clientSide.startResize(window, globalPos, frameSection);
+    }
+
+private:
+    ClientSideMoveResize m_clientSide;
+};
+
+/*!
+    Ignores every request, for the platforms without a window system.
+ */
+class NullWindowSystemBackend : public WindowSystemBackend
+{
+public:
+    QString name() const override
+    {
+        return QStringLiteral("null");
+    }
+
+    void startMove(QWindow *window, const QPoint &globalPos) override
+    {
+        Q_UNUSED(window);
+        Q_UNUSED(globalPos);
+    }
+
+    void startResize(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection) override
+    {
+        Q_UNUSED(window);
+        Q_UNUSED(globalPos);
+        Q_UNUSED(frameSection);
+    }
+
+    void setResizeCursor(QWindow *window, const Qt::WindowFrameSection frameSection) override
+    {
+        Q_UNUSED(window);
+        Q_UNUSED(frameSection);
+    }
+
+    void unsetResizeCursor(QWindow *window) override
+    {
+        Q_UNUSED(window);
+    }
+};
+
+struct WindowSystemBackendData
+{
+    QScopedPointer<WindowSystemBackend> backend;
+};
+
+Q_GLOBAL_STATIC(WindowSystemBackendData, g_windowSystemBackendData)
+
+static QString defaultBackendName()
+{
+    const QString platform = QGuiApplication::platformName();
+    if (platform == QStringLiteral("xcb")) {
+        return QStringLiteral("xcb");
+    }
+    if (platform == QStringLiteral("cocoa")) {
+        return QStringLiteral("cocoa");
+    }
+    if (platform == QStringLiteral("offscreen") || platform == QStringLiteral("minimal")) {
+        return QStringLiteral("null");
+    }
+    return QStringLiteral("qt");
+}
+
+WindowSystemBackend *WindowSystemBackend::create(const QString &name)
+{
+#ifdef FRAMELESSHELPER_HAS_X11
+    // QX11Info can't be used with any other platform plugin.
+    if (name == QStringLiteral("xcb") && QX11Info::isPlatformX11()) {
+        return new XcbWindowSystemBackend;
+    }
+    if (name == QStringLiteral("xlib") && QX11Info::isPlatformX11()) {
+        return new XlibWindowSystemBackend;
+    }
+#endif
+#ifdef Q_OS_MAC
+    if (name == QStringLiteral("cocoa")) {
+        return new CocoaWindowSystemBackend;
+    }
+#endif
+    if (name == QStringLiteral("client")) {
+        return new ClientSideWindowSystemBackend;
+    }
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 15, 0))
+    if (name == QStringLiteral("qt")) {
+        return new QtWindowSystemBackend;
+    }
+#endif
+    if (name == QStringLiteral("null")) {
+        return new NullWindowSystemBackend;
+    }
+    return nullptr;
+}
+
+WindowSystemBackend *WindowSystemBackend::instance()
+{
+    WindowSystemBackendData *data = g_windowSystemBackendData();
+    if (!data) {
+        return nullptr;
+    }
+    if (data->backend.isNull()) {
+        const QString name = qEnvironmentVariable("FRAMELESSHELPER_BACKEND");
+        WindowSystemBackend *backend = name.isEmpty() ? nullptr : create(name);
+        if (!name.isEmpty() && !backend) {
+            qWarning() << "The" << name << "backend is not available.";
+        }
+        if (!backend) {
+            backend = create(defaultBackendName());
+        }
+        if (!backend) {
+            // E.g. on Wayland before Qt 5.15, at least keep the windows movable.
+            qWarning() << "No usable backend for" << QGuiApplication::platformName()
+                       << "found, falling back to client side moves and resizes.";
+            backend = new ClientSideWindowSystemBackend;
+        }
+        data->backend.reset(backend);
+    }
+    return data->backend.data();
+}
+
+void WindowSystemBackend::setInstance(WindowSystemBackend *backend)
+{
+    WindowSystemBackendData *data = g_windowSystemBackendData();
+    if (!data) {
+        delete backend;
+        return;
+    }
+    data->backend.reset(backend);
+}
+
+QString RecordingWindowSystemBackend::name() const
+{
+    return QStringLiteral("recording");
+}
+
+void RecordingWindowSystemBackend::startMove(QWindow *window, const QPoint &globalPos)
+{
+    Request request;
+    request.type = RequestType::Move;
+    request.window = window;
+    request.globalPos = globalPos;
+    m_requests.append(request);
+}
+
+void RecordingWindowSystemBackend::startResize(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection)
+{
+    Request request;
+    request.type = RequestType::Resize;
+    request.window = window;
+    request.globalPos = globalPos;
+    request.frameSection = frameSection;
+    m_requests.append(request);
+}
+
+void RecordingWindowSystemBackend::setResizeCursor(QWindow *window, const Qt::WindowFrameSection frameSection)
+{
+    Request request;
+    request.type = RequestType::SetCursor;
+    request.window = window;
+    request.frameSection = frameSection;
+    m_requests.append(request);
+}
+
+void RecordingWindowSystemBackend::unsetResizeCursor(QWindow *window)
+{
+    Request request;
+    request.type = RequestType::UnsetCursor;
+    request.window = window;
+    m_requests.append(request);
+}
+
+FRAMELESSHELPER_END_NAMESPACE
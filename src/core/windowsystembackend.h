@@ -0,0 +1,114 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qpoint.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qvector.h>
+
+QT_BEGIN_NAMESPACE
+QT_FORWARD_DECLARE_CLASS(QWindow)
+QT_END_NAMESPACE
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    Starts interactive moves and resizes and sets the resize cursors, for
+    the window system the application is running on.
+
+    The backend is chosen once, from the QPA platform plugin: xcb (or the
+    older Xlib one on request) for X11, Cocoa on macOS, QWindow::startSystemMove() and startSystemResize() for
+    the other platforms (Qt 5.15 and newer), and a backend which does
+    nothing for offscreen and minimal. When none of them is available the
+    windows are moved and resized by the client. The FRAMELESSHELPER_BACKEND
+    environment variable ("xcb", "xlib", "cocoa", "qt", "client" or "null")
+    overrides the choice.
+ */
+class FRAMELESSHELPER_API WindowSystemBackend
+{
+    Q_DISABLE_COPY_MOVE(WindowSystemBackend)
+
+public:
+    WindowSystemBackend() = default;
+    virtual ~WindowSystemBackend() = default;
+
+    virtual QString name() const = 0;
+
+    virtual void startMove(QWindow *window, const QPoint &globalPos) = 0;
+    virtual void startResize(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection) = 0;
+
+    // Uses QWindow::setCursor() by default.
+    virtual void setResizeCursor(QWindow *window, const Qt::WindowFrameSection frameSection);
+    virtual void unsetResizeCursor(QWindow *window);
+
+    static Qt::CursorShape cursorShapeForFrameSection(const Qt::WindowFrameSection frameSection);
+
+    static WindowSystemBackend *instance();
+    // Takes the ownership, the previous backend is deleted.
+    static void setInstance(WindowSystemBackend *backend);
+    // Returns nullptr if the backend is not available in this build.
+    static WindowSystemBackend *create(const QString &name);
+};
+
+/*!
+    A backend which only records the requests, for running the hit testing
+    and the drag logic on machines without a window system. It is never
+    chosen on its own, install it with WindowSystemBackend::setInstance().
+ */
+class FRAMELESSHELPER_API RecordingWindowSystemBackend : public WindowSystemBackend
+{
+public:
+    enum class RequestType : int
+    {
+        Move = 0,
+        Resize,
+        SetCursor,
+        UnsetCursor
+    };
+
+    struct Request
+    {
+        RequestType type = RequestType::Move;
+        QWindow *window = nullptr;
+        QPoint globalPos;
+        Qt::WindowFrameSection frameSection = Qt::NoSection;
+    };
+
+    QString name() const override;
+
+    void startMove(QWindow *window, const QPoint &globalPos) override;
+    void startResize(QWindow *window, const QPoint &globalPos, const Qt::WindowFrameSection frameSection) override;
+    void setResizeCursor(QWindow *window, const Qt::WindowFrameSection frameSection) override;
+    void unsetResizeCursor(QWindow *window) override;
+
+    QVector<Request> requests() const { return m_requests; }
+    void clear() { m_requests.clear(); }
+
+private:
+    QVector<Request> m_requests;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
@@ -0,0 +1,246 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "xsettings.h"
+#include "systemmetriccache.h"
+#include "utilities.h"
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qdebug.h>
+#include <QtCore/qendian.h>
+#include <QtGui/qcolor.h>
+#include <QtX11Extras/qx11info_x11.h>
+#include <xcb/xcb.h>
+#include <cstdlib>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+Q_GLOBAL_STATIC(XSettings, g_xsettings)
+
+static xcb_atom_t internAtom(xcb_connection_t *connection, const QByteArray &name)
+{
+    const xcb_intern_atom_cookie_t cookie = xcb_intern_atom(connection, false, uint16_t(name.size()), name.constData());
+    xcb_intern_atom_reply_t *reply = xcb_intern_atom_reply(connection, cookie, nullptr);
+    const xcb_atom_t atom = reply ? reply->atom : xcb_atom_t(XCB_ATOM_NONE);
+    free(reply);
+    return atom;
+}
+
+XSettings::XSettings(QObject *parent) : QObject(parent)
+{
+    if (!QX11Info::isPlatformX11()) {
+        return;
+    }
+
+    xcb_connection_t *connection = QX11Info::connection();
+    m_selection = internAtom(connection, "_XSETTINGS_S" + QByteArray::number(QX11Info::appScreen()));
+    m_settingsAtom = internAtom(connection, "_XSETTINGS_SETTINGS");
+    m_managerAtom = internAtom(connection, "MANAGER");
+
+    // A (re)started settings manager announces itself with a MANAGER client
+    // message to the root window, sent with StructureNotify.
+    Utilities::selectX11Events(quint32(QX11Info::appRootWindow(QX11Info::appScreen())),
+                               XCB_EVENT_MASK_STRUCTURE_NOTIFY);
+
+    QCoreApplication::instance()->installNativeEventFilter(this);
+    updateOwner();
+}
+
+XSettings *XSettings::instance()
+{
+    return g_xsettings();
+}
+
+void XSettings::updateOwner()
+{
+    xcb_connection_t *connection = QX11Info::connection();
+    xcb_get_selection_owner_reply_t *reply = xcb_get_selection_owner_reply(
+        connection, xcb_get_selection_owner(connection, m_selection), nullptr);
+    m_owner = reply ? reply->owner : XCB_WINDOW_NONE;
+    free(reply);
+
+    if (m_owner != XCB_WINDOW_NONE) {
+        // Before reading, so that no change gets lost in between. The mask
+        // is per connection, and the connection is shared with Qt.
+        Utilities::selectX11Events(m_owner, XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_STRUCTURE_NOTIFY);
+    }
+    updateSettings();
+}
+
+void XSettings::updateSettings()
+{
+    QHash<QByteArray, QVariant> settings;
+    if (m_owner != XCB_WINDOW_NONE) {
+        xcb_connection_t *connection = QX11Info::connection();
+        xcb_get_property_reply_t *reply = xcb_get_property_reply(connection,
+            xcb_get_property(connection, false, m_owner, m_settingsAtom, m_settingsAtom, 0, UINT32_MAX / 4), nullptr);
+        if (reply && reply->format == 8) {
+            const QByteArray data(static_cast<const char *>(xcb_get_property_value(reply)),
+                                  xcb_get_property_value_length(reply));
+            if (!parse(data, &settings)) {
+                qWarning() << "Malformed XSETTINGS data was ignored.";
+                settings.clear();
+            }
+        }
+        free(reply);
+    }
+
+    if (settings == m_settings) {
+        return;
+    }
+    m_settings = settings;
+    m_xftDpi = m_settings.value(QByteArrayLiteral("Xft/DPI"), -1).toInt();
+    m_windowScalingFactor = qMax(1, m_settings.value(QByteArrayLiteral("Gdk/WindowScalingFactor"), 1).toInt());
+
+    SystemMetricCache::invalidate();
+    Q_EMIT settingsChanged();
+}
+
+/*!
+    Parses the _XSETTINGS_SETTINGS property, as laid out by the XSETTINGS
+    specification. Returns false if \a data is truncated or malformed.
+ */
+bool XSettings::parse(const QByteArray &data, QHash<QByteArray, QVariant> *settings)
+{
+    Q_ASSERT(settings);
+    if (!settings) {
+        return false;
+    }
+
+    const auto bytes = reinterpret_cast<const uchar *>(data.constData());
+    const int size = data.size();
+    if (size < 12) {
+        return false;
+    }
+    // 0 is LSBFirst, 1 is MSBFirst.
+    const bool bigEndian = bytes[0] == 1;
+    const auto card16 = [bytes, bigEndian](const int offset) -> quint16 {
+        return bigEndian ? qFromBigEndian<quint16>(bytes + offset) : qFromLittleEndian<quint16>(bytes + offset);
+    };
+    const auto card32 = [bytes, bigEndian](const int offset) -> quint32 {
+        return bigEndian ? qFromBigEndian<quint32>(bytes + offset) : qFromLittleEndian<quint32>(bytes + offset);
+    };
+    const auto pad4 = [](const quint32 length) -> quint32 {
+        return (length + 3) & ~quint32(3);
+    };
+
+    const quint32 count = card32(8);
+    quint32 offset = 12;
+    for (quint32 i = 0; i < count; ++i) {
+        // Type, pad, name length.
+        if (offset + 4 > quint32(size)) {
+            return false;
+        }
+        const uchar type = bytes[offset];
+        const quint32 nameLength = card16(offset + 2);
+        offset += 4;
+        if (offset + pad4(nameLength) + 4 > quint32(size)) {
+            return false;
+        }
+        const QByteArray name(data.constData() + offset, int(nameLength));
+        // The name, padded, and the serial of the last change.
+        offset += pad4(nameLength) + 4;
+
+        switch (type) {
+        case 0: { // Integer
+            if (offset + 4 > quint32(size)) {
+                return false;
+            }
+            settings->insert(name, int(qint32(card32(offset))));
+            offset += 4;
+            break;
+        }
+        case 1: { // String
+            if (offset + 4 > quint32(size)) {
+                return false;
+            }
+            const quint32 length = card32(offset);
+            offset += 4;
+            if (length > quint32(size) || offset + pad4(length) > quint32(size)) {
+                return false;
+            }
+            settings->insert(name, QByteArray(data.constData() + offset, int(length)));
+            offset += pad4(length);
+            break;
+        }
+        case 2: { // Color, 16 bit red, green, blue and alpha.
+            if (offset + 8 > quint32(size)) {
+                return false;
+            }
+            QColor color;
+            color.setRgba64(QRgba64::fromRgba64(card16(offset), card16(offset + 2),
+                                                card16(offset + 4), card16(offset + 6)));
+            settings->insert(name, color);
+            offset += 8;
+            break;
+        }
+        default:
+            return false;
+        }
+    }
+    return true;
+}
+
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+bool XSettings::nativeEventFilter(const QByteArray &eventType, void *message, qintptr *result)
+#else
+bool XSettings::nativeEventFilter(const QByteArray &eventType, void *message, long *result)
+#endif
+{
+    Q_UNUSED(result);
+    if ((eventType != QByteArrayLiteral("xcb_generic_event_t")) || !message) {
+        return false;
+    }
+
+    const auto event = static_cast<const xcb_generic_event_t *>(message);
+    switch (event->response_type & ~0x80) {
+    case XCB_PROPERTY_NOTIFY: {
+        const auto ev = reinterpret_cast<const xcb_property_notify_event_t *>(event);
+        if (m_owner != XCB_WINDOW_NONE && ev->window == m_owner && ev->atom == m_settingsAtom) {
+            updateSettings();
+        }
+        break;
+    }
+    case XCB_DESTROY_NOTIFY: {
+        const auto ev = reinterpret_cast<const xcb_destroy_notify_event_t *>(event);
+        if (m_owner != XCB_WINDOW_NONE && ev->window == m_owner) {
+            // The manager went away, maybe a new one is already running.
+            updateOwner();
+        }
+        break;
+    }
+    case XCB_CLIENT_MESSAGE: {
+        // A new manager announces itself on the root window.
+        const auto ev = reinterpret_cast<const xcb_client_message_event_t *>(event);
+        if (ev->type == m_managerAtom && ev->format == 32 && ev->data.data32[1] == m_selection) {
+            updateOwner();
+        }
+        break;
+    }
+    default:
+        break;
+    }
+    return false;
+}
+
+FRAMELESSHELPER_END_NAMESPACE
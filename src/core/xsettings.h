@@ -0,0 +1,90 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "framelesshelper_global.h"
+#include <QtCore/qobject.h>
+#include <QtCore/qabstractnativeeventfilter.h>
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qvariant.h>
+
+FRAMELESSHELPER_BEGIN_NAMESPACE
+
+/*!
+    The XSETTINGS of the desktop (GNOME, Xfce, MATE and the other GTK based
+    ones, and KDE through its XSETTINGS daemon).
+
+    The settings are read from the selection owner once, and again only
+    when the owner reports a PropertyNotify or a new settings manager
+    starts, so the getters are plain member reads. Strings are kept as
+    QByteArray, integers as int and colors as QColor.
+ */
+class FRAMELESSHELPER_API XSettings : public QObject, public QAbstractNativeEventFilter
+{
+    Q_OBJECT
+    Q_DISABLE_COPY_MOVE(XSettings)
+
+public:
+    explicit XSettings(QObject *parent = nullptr);
+    ~XSettings() override = default;
+
+    static XSettings *instance();
+
+    // Whether a settings manager is running.
+    bool isValid() const { return m_owner != 0; }
+
+    QVariant value(const QByteArray &name) const { return m_settings.value(name); }
+
+    // Xft/DPI, in 1/1024 of a DPI. -1 if not set.
+    int xftDpi() const { return m_xftDpi; }
+    // Gdk/WindowScalingFactor, 1 if not set.
+    int windowScalingFactor() const { return m_windowScalingFactor; }
+
+    static bool parse(const QByteArray &data, QHash<QByteArray, QVariant> *settings);
+
+#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
+    bool nativeEventFilter(const QByteArray &eventType, void *message, qintptr *result) override;
+#else
+    bool nativeEventFilter(const QByteArray &eventType, void *message, long *result) override;
+#endif
+
+Q_SIGNALS:
+    void settingsChanged();
+
+private:
+    void updateOwner();
+    void updateSettings();
+
+    quint32 m_selection = 0;
+    quint32 m_settingsAtom = 0;
+    quint32 m_managerAtom = 0;
+    quint32 m_owner = 0;
+    QHash<QByteArray, QVariant> m_settings;
+    int m_xftDpi = -1;
+    int m_windowScalingFactor = 1;
+};
+
+FRAMELESSHELPER_END_NAMESPACE
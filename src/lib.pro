@@ -13,13 +13,41 @@ DEFINES += \
     FRAMELESSHELPER_BUILD_LIBRARY
 HEADERS += \
     framelesshelper_global.h \
+    clientsidemoveresize.h \
+    dragregionmap.h \
+    framelesseventhub.h \
     framelesshelper.h \
+    framelessprofile.h \
+    framezones.h \
+    hitmask.h \
+    hittestindex.h \
+    hittestvisibleregistry.h \
+    objectgeometry.h \
+    objectregistry.h \
+    spanregion.h \
+    systemmetriccache.h \
     framelesswindowsmanager.h \
-    utilities.h
+    utilities.h \
+    windowstateregistry.h \
+    windowsystembackend.h
 SOURCES += \
+    clientsidemoveresize.cpp \
+    dragregionmap.cpp \
+    framelesseventhub.cpp \
     framelesshelper.cpp \
+    framelessprofile.cpp \
+    framezones.cpp \
+    hitmask.cpp \
+    hittestindex.cpp \
+    hittestvisibleregistry.cpp \
+    objectgeometry.cpp \
+    spanregion.cpp \
+    systemmetriccache.cpp \
     framelesswindowsmanager.cpp \
-    utilities.cpp
+    utilities.cpp \
+    windowstateregistry.cpp \
+    windowsystembackend.cpp
+qtHaveModule(widgets): QT += widgets
 qtHaveModule(quick) {
     QT += quick
     HEADERS += framelessquickhelper.h
@@ -35,3 +63,16 @@ win32 {
     LIBS += -luser32 -lshell32 -ldwmapi
     RC_FILE = framelesshelper.rc
 }
+unix:!macx {
+    HEADERS += themewatcher.h
+    SOURCES += \
+        themewatcher.cpp \
+        utilities_linux.cpp
+    qtHaveModule(x11extras) {
+        QT += x11extras
+        DEFINES += FRAMELESSHELPER_HAS_X11
+        HEADERS += xsettings.h
+        SOURCES += xsettings.cpp
+        LIBS += -lX11 -lxcb
+    }
+}
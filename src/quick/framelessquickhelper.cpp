@@ -24,45 +24,136 @@
 
 #include "framelessquickhelper.h"
 #include "core/framelesswindowsmanager.h"
+#include "core/systemmetriccache.h"
+#include <QtGui/qscreen.h>
 #include <QtQuick/qquickwindow.h>
 
 FRAMELESSHELPER_BEGIN_NAMESPACE
 
 FramelessQuickHelper::FramelessQuickHelper(QQuickItem *parent) : QQuickItem(parent)
 {
+    // Settings changed through the manager or a profile, not through this item.
+    if (FramelessWindowsNotifier *notifier = FramelessWindowsManager::notifier()) {
+        connect(notifier, &FramelessWindowsNotifier::windowSettingsChanged, this, [this](QWindow *win){
+            if (win == window()) {
+                invalidateValues();
+            }
+        });
+    }
+    // System setting, theme and XSETTINGS changes.
+    if (SystemMetricNotifier *notifier = SystemMetricCache::notifier()) {
+        connect(notifier, &SystemMetricNotifier::invalidated, this, &FramelessQuickHelper::invalidateValues);
+    }
+}
+
+const FramelessQuickHelper::Values &FramelessQuickHelper::values() const
+{
+    if (m_valuesDirty) {
+        m_valuesDirty = false;
+        m_values = Values();
+        if (const QQuickWindow *win = window()) {
+            m_values.resizeBorderThickness = FramelessWindowsManager::getResizeBorderThickness(win);
+            m_values.titleBarHeight = FramelessWindowsManager::getTitleBarHeight(win);
+            m_values.resizable = FramelessWindowsManager::getResizable(win);
+        }
+    }
+    return m_values;
+}
+
+/*!
+    The values are read again on the next query, and the changed ones are
+    announced before the next frame. Changes coming close together, e.g. a
+    move to another screen together with a state change, are reported once.
+ */
+void FramelessQuickHelper::invalidateValues()
+{
+    m_valuesDirty = true;
+    polish();
+}
+
+void FramelessQuickHelper::updateScreenConnection()
+{
+    disconnect(m_dpiConnection);
+    const QQuickWindow *win = window();
+    QScreen *screen = win ? win->screen() : nullptr;
+    if (screen) {
+        // The system metrics are DPI dependent.
+        m_dpiConnection = connect(screen, &QScreen::logicalDotsPerInchChanged, this, &FramelessQuickHelper::invalidateValues);
+    }
+}
+
+void FramelessQuickHelper::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    QQuickItem::itemChange(change, value);
+    if (change != ItemSceneChange) {
+        return;
+    }
+    disconnect(m_screenChangedConnection);
+    disconnect(m_windowStateConnection);
+    if (value.window) {
+        m_screenChangedConnection = connect(value.window, &QWindow::screenChanged, this, [this](){
+            updateScreenConnection();
+            invalidateValues();
+        });
+        // The title bar height depends on the window state.
+        m_windowStateConnection = connect(value.window, &QWindow::windowStateChanged, this, &FramelessQuickHelper::invalidateValues);
+    }
+    updateScreenConnection();
+    // Nothing changed for the new window yet, only later changes are
+    // announced.
+    m_valuesDirty = true;
+    m_notifiedValues = values();
+}
+
+void FramelessQuickHelper::updatePolish()
+{
+    QQuickItem::updatePolish();
+    const Values &current = values();
+    const Values previous = m_notifiedValues;
+    m_notifiedValues = current;
+    if (!qFuzzyCompare(current.resizeBorderThickness, previous.resizeBorderThickness)) {
+        Q_EMIT resizeBorderThicknessChanged(current.resizeBorderThickness);
+    }
+    if (!qFuzzyCompare(current.titleBarHeight, previous.titleBarHeight)) {
+        Q_EMIT titleBarHeightChanged(current.titleBarHeight);
+    }
+    if (current.resizable != previous.resizable) {
+        Q_EMIT resizableChanged(current.resizable);
+    }
 }
 
 qreal FramelessQuickHelper::resizeBorderThickness() const
 {
-    return FramelessWindowsManager::getResizeBorderThickness(window());
+    return values().resizeBorderThickness;
 }
 
 void FramelessQuickHelper::setResizeBorderThickness(const qreal val)
 {
+    // The manager ignores values equal to the stored ones, and announces
+    // the others.
     FramelessWindowsManager::setResizeBorderThickness(window(), qRound(val));
-    Q_EMIT resizeBorderThicknessChanged(val);
 }
 
 qreal FramelessQuickHelper::titleBarHeight() const
 {
-    return FramelessWindowsManager::getTitleBarHeight(window());
+    return values().titleBarHeight;
 }
 
 void FramelessQuickHelper::setTitleBarHeight(const qreal val)
 {
+    // The manager ignores values equal to the stored ones, and announces
+    // the others.
     FramelessWindowsManager::setTitleBarHeight(window(), qRound(val));
-    Q_EMIT titleBarHeightChanged(val);
 }
 
 bool FramelessQuickHelper::resizable() const
 {
-    return FramelessWindowsManager::getResizable(window());
+    return values().resizable;
 }
 
 void FramelessQuickHelper::setResizable(const bool val)
 {
     FramelessWindowsManager::setResizable(window(), val);
-    Q_EMIT resizableChanged(val);
 }
 
 void FramelessQuickHelper::removeWindowFrame()
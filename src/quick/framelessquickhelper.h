@@ -53,6 +53,10 @@ public:
     Q_NODISCARD bool resizable() const;
     void setResizable(const bool val);
 
+protected:
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+    void updatePolish() override;
+
 public Q_SLOTS:
     void removeWindowFrame();
     void bringBackWindowFrame();
@@ -63,6 +67,28 @@ Q_SIGNALS:
     void resizeBorderThicknessChanged(qreal);
     void titleBarHeightChanged(qreal);
     void resizableChanged(bool);
+
+private:
+    struct Values
+    {
+        qreal resizeBorderThickness = 0.0;
+        qreal titleBarHeight = 0.0;
+        bool resizable = true;
+    };
+
+    const Values &values() const;
+    void invalidateValues();
+    void updateScreenConnection();
+
+    // Read from FramelessWindowsManager when first needed after a change.
+    mutable Values m_values;
+    mutable bool m_valuesDirty = true;
+    // What the NOTIFY signals last reported, they are emitted from
+    // updatePolish(), at most once per frame.
+    Values m_notifiedValues;
+    QMetaObject::Connection m_screenChangedConnection;
+    QMetaObject::Connection m_windowStateConnection;
+    QMetaObject::Connection m_dpiConnection;
 };
 
 FRAMELESSHELPER_END_NAMESPACE
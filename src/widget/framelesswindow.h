@@ -26,9 +26,9 @@ public:
         m_helper->setResizable(reziable);
     }
 
-    void setHitTestVisible(QObject *obj)
+    void setHitTestVisible(QObject *obj, bool visible = true)
     {
-        m_helper->setHitTestVisible(obj);
+        m_helper->setHitTestVisible(obj, visible);
     }
 
     void setResizeBorderThickness(int thickness) {
@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "core/framezones.h"
+#include <QtCore/qrandom.h>
+#include <QtCore/qvector.h>
+#include <QtTest/qtest.h>
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+/*!
+    The batched FrameZones::classify() uses SSE2 or NEON where available,
+    it must give exactly the same answers as the scalar one.
+ */
+class tst_FrameZones : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void batchMatchesScalar_data();
+    void batchMatchesScalar();
+    void emptyBatch();
+};
+
+static void addBoundary(QVector<QPoint> *points, const int left, const int top, const int right, const int bottom)
+{
+    // Each edge, one pixel on both sides of it, which includes the corners.
+    const int xs[] = {left - 1, left, left + 1, right - 1, right, right + 1};
+    const int ys[] = {top - 1, top, top + 1, bottom - 1, bottom, bottom + 1};
+    for (const int x : xs) {
+        for (const int y : ys) {
+            points->append({x, y});
+        }
+    }
+}
+
+void tst_FrameZones::batchMatchesScalar_data()
+{
+    QTest::addColumn<int>("width");
+    QTest::addColumn<int>("height");
+    QTest::addColumn<int>("border");
+    QTest::addColumn<int>("corner");
+    QTest::addColumn<int>("titleBarHeight");
+
+    QTest::newRow("normal") << 800 << 600 << 8 << 16 << 32;
+    QTest::newRow("corner same as border") << 800 << 600 << 8 << 8 << 32;
+    QTest::newRow("no border") << 800 << 600 << 0 << 0 << 32;
+    QTest::newRow("no corner") << 800 << 600 << 8 << 0 << 32;
+    QTest::newRow("no title bar") << 800 << 600 << 8 << 16 << 0;
+    QTest::newRow("title bar taller than window") << 100 << 20 << 4 << 8 << 40;
+    QTest::newRow("smaller than the zones") << 10 << 10 << 8 << 16 << 32;
+    QTest::newRow("one pixel") << 1 << 1 << 1 << 1 << 1;
+    QTest::newRow("empty window") << 0 << 0 << 8 << 16 << 32;
+    QTest::newRow("zero width") << 0 << 600 << 8 << 16 << 32;
+    QTest::newRow("zero height") << 800 << 0 << 8 << 16 << 32;
+}
+
+void tst_FrameZones::batchMatchesScalar()
+{
+    QFETCH(int, width);
+    QFETCH(int, height);
+    QFETCH(int, border);
+    QFETCH(int, corner);
+    QFETCH(int, titleBarHeight);
+
+    FrameZones zones;
+    zones.update(width, height, border, corner, titleBarHeight);
+
+    QVector<QPoint> points;
+    addBoundary(&points, 0, 0, width, height);
+    for (int z = 0; z != FrameZones::ZoneCount; ++z) {
+        addBoundary(&points, zones.left[z], zones.top[z], zones.right[z], zones.bottom[z]);
+    }
+    for (const int y : {titleBarHeight - 1, titleBarHeight, titleBarHeight + 1}) {
+        for (const int x : {-1, 0, width / 2, width - 1, width}) {
+            points.append({x, y});
+        }
+    }
+    // Fixed seed, so that a failure can be reproduced.
+    QRandomGenerator generator(42);
+    for (int i = 0; i != 4096; ++i) {
+        points.append({generator.bounded(-10, width + 10), generator.bounded(-10, height + 10)});
+    }
+
+    QVector<Qt::WindowFrameSection> expected;
+    expected.reserve(points.size());
+    for (const QPoint &point : qAsConst(points)) {
+        expected.append(zones.classify(point));
+    }
+
+    // Every start offset, so that the vectorized loop and the scalar tail
+    // both see every point.
+    for (int offset = 0; offset != 4; ++offset) {
+        const int count = points.size() - offset;
+        QVector<Qt::WindowFrameSection> sections(count, Qt::NoSection);
+        zones.classify(points.constData() + offset, sections.data(), count);
+        for (int i = 0; i != count; ++i) {
+            const QPoint &point = points.at(offset + i);
+            QVERIFY2(sections.at(i) == expected.at(offset + i),
+                     qPrintable(QStringLiteral("(%1, %2): %3 instead of %4").arg(point.x()).arg(point.y())
+                                .arg(int(sections.at(i))).arg(int(expected.at(offset + i)))));
+        }
+    }
+}
+
+void tst_FrameZones::emptyBatch()
+{
+    FrameZones zones;
+    zones.update(800, 600, 8, 16, 32);
+    zones.classify(nullptr, nullptr, 0);
+}
+
+QTEST_APPLESS_MAIN(tst_FrameZones)
+
+#include "tst_framezones.moc"
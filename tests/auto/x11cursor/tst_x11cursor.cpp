@@ -0,0 +1,179 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "core/framelesshelper.h"
+#include "core/windowsystembackend.h"
+#include <QtGui/qwindow.h>
+#include <QtTest/qtest.h>
+#include <QtX11Extras/qx11info_x11.h>
+#include <xcb/xcb.h>
+#include <cstdlib>
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+/*!
+    Counts the X requests sent by the Xlib backend while the mouse sweeps
+    over the resize borders. A cursor must only be created once and only
+    be defined when the hovered section changes.
+ */
+class tst_X11Cursor : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void init();
+    void cleanup();
+    void hoverSweep();
+    void hoverSameSection();
+
+private:
+    int sweep(const QVector<QPoint> &points);
+    int expectedRequests(const QVector<QPoint> &points);
+
+    QWindow *m_window = nullptr;
+    FramelessHelper *m_helper = nullptr;
+};
+
+/*!
+    The sequence number of a round trip request. Xlib and Qt share the xcb
+    connection, so the difference between two of them minus one is the
+    number of requests sent in between, whichever library sent them.
+ */
+static unsigned int syncSequence()
+{
+    xcb_connection_t *connection = QX11Info::connection();
+    const xcb_get_input_focus_cookie_t cookie = xcb_get_input_focus(connection);
+    free(xcb_get_input_focus_reply(connection, cookie, nullptr));
+    return cookie.sequence;
+}
+
+static QVector<QPoint> sweepPoints(const QSize &size)
+{
+    QVector<QPoint> points;
+    // Down the left border, along the bottom one, then through the middle.
+    for (int y = 0; y != size.height(); ++y) {
+        points.append({2, y});
+    }
+    for (int x = 0; x != size.width(); ++x) {
+        points.append({x, size.height() - 3});
+    }
+    for (int x = 0; x != size.width(); ++x) {
+        points.append({x, size.height() / 2});
+    }
+    return points;
+}
+
+void tst_X11Cursor::initTestCase()
+{
+    if (!QX11Info::isPlatformX11()) {
+        QSKIP("Needs the xcb platform, run it with xvfb-run.");
+    }
+    WindowSystemBackend *backend = WindowSystemBackend::create(QStringLiteral("xlib"));
+    QVERIFY(backend);
+    WindowSystemBackend::setInstance(backend);
+}
+
+void tst_X11Cursor::init()
+{
+    m_window = new QWindow;
+    m_window->resize(400, 300);
+    m_window->show();
+    QVERIFY(QTest::qWaitForWindowExposed(m_window));
+
+    m_helper = new FramelessHelper(m_window);
+    m_helper->setWindowSize(m_window->size());
+    m_helper->setResizeBorderThickness(8);
+    m_helper->setTitleBarHeight(30);
+    m_helper->setResizable(true);
+}
+
+void tst_X11Cursor::cleanup()
+{
+    delete m_helper;
+    m_helper = nullptr;
+    delete m_window;
+    m_window = nullptr;
+}
+
+int tst_X11Cursor::sweep(const QVector<QPoint> &points)
+{
+    const unsigned int before = syncSequence();
+    for (const QPoint &point : points) {
+        m_helper->updateMouse(point);
+    }
+    const unsigned int after = syncSequence();
+    return int(after - before) - 1;
+}
+
+// One request each time the cursor has to change, and nothing else.
+int tst_X11Cursor::expectedRequests(const QVector<QPoint> &points)
+{
+    int requests = 0;
+    Qt::WindowFrameSection current = Qt::NoSection;
+    for (const QPoint &point : points) {
+        Qt::WindowFrameSection section = m_helper->mapPosToFrameSection(point);
+        if (section == Qt::TitleBarArea) {
+            section = Qt::NoSection;
+        }
+        if (section != current) {
+            ++requests;
+            current = section;
+        }
+    }
+    return requests;
+}
+
+void tst_X11Cursor::hoverSweep()
+{
+    const QVector<QPoint> points = sweepPoints(m_window->size());
+
+    // The first sweep loads the cursors.
+    sweep(points);
+    m_helper->updateMouse({m_window->width() / 2, m_window->height() / 2});
+
+    const int expected = expectedRequests(points);
+    QVERIFY(expected > 0);
+    const int requests = sweep(points);
+    qDebug() << points.size() << "hover updates," << requests << "X requests.";
+    QVERIFY2(requests <= expected, qPrintable(QStringLiteral("%1 requests, %2 expected").arg(requests).arg(expected)));
+}
+
+void tst_X11Cursor::hoverSameSection()
+{
+    const QPoint point(2, m_window->height() / 2);
+    m_helper->updateMouse(point);
+    QCOMPARE(m_helper->mapPosToFrameSection(point), Qt::LeftSection);
+
+    QVector<QPoint> points;
+    for (int y = m_window->height() / 2 - 50; y != m_window->height() / 2 + 50; ++y) {
+        points.append({1 + (y % 4), y});
+    }
+    QCOMPARE(sweep(points), 0);
+}
+
+QTEST_MAIN(tst_X11Cursor)
+
+#include "tst_x11cursor.moc"
@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "core/windowstateregistry.h"
+#include <QtGui/qguiapplication.h>
+#include <QtGui/qwindow.h>
+#include <QtTest/qtest.h>
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+/*!
+    Mapping a native handle to its window with 1 to 500 top level windows,
+    through the WindowStateRegistry index and through the scan of all top
+    level windows that Utilities::findWindow() used to do. A hit is the
+    most recently created window, a miss is a handle which belongs to none
+    of them, like the messages of the windows that are not frameless.
+ */
+class tst_bench_FindWindow : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void cleanup();
+    void scan_data();
+    void scan();
+    void index_data();
+    void index();
+
+private:
+    static void addCounts();
+    void createWindows(const int count);
+
+    QVector<QWindow *> m_windows;
+};
+
+static QWindow *scanTopLevelWindows(const WId winId)
+{
+    const QWindowList windows = QGuiApplication::topLevelWindows();
+    for (auto &&window : qAsConst(windows)) {
+        if (window && window->handle()) {
+            if (window->winId() == winId) {
+                return window;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void tst_bench_FindWindow::cleanup()
+{
+    qDeleteAll(m_windows);
+    m_windows.clear();
+}
+
+void tst_bench_FindWindow::addCounts()
+{
+    QTest::addColumn<int>("count");
+    QTest::addColumn<bool>("hit");
+    for (const int count : {1, 10, 50, 100, 500}) {
+        QTest::newRow(qPrintable(QStringLiteral("%1 windows, hit").arg(count))) << count << true;
+        QTest::newRow(qPrintable(QStringLiteral("%1 windows, miss").arg(count))) << count << false;
+    }
+}
+
+void tst_bench_FindWindow::createWindows(const int count)
+{
+    m_windows.reserve(count);
+    for (int i = 0; i != count; ++i) {
+        auto window = new QWindow;
+        // The platform window, and so the native handle, without showing it.
+        window->create();
+        WindowStateRegistry::ensure(window)->frameless = true;
+        m_windows.append(window);
+    }
+}
+
+void tst_bench_FindWindow::scan_data()
+{
+    addCounts();
+}
+
+void tst_bench_FindWindow::scan()
+{
+    QFETCH(int, count);
+    QFETCH(bool, hit);
+    createWindows(count);
+    QWindow *expected = hit ? m_windows.constLast() : nullptr;
+    const WId winId = hit ? expected->winId() : WId(-1);
+    QWindow *window = nullptr;
+    QBENCHMARK {
+        window = scanTopLevelWindows(winId);
+    }
+    QCOMPARE(window, expected);
+}
+
+void tst_bench_FindWindow::index_data()
+{
+    addCounts();
+}
+
+void tst_bench_FindWindow::index()
+{
+    QFETCH(int, count);
+    QFETCH(bool, hit);
+    createWindows(count);
+    QWindow *expected = hit ? m_windows.constLast() : nullptr;
+    const WId winId = hit ? expected->winId() : WId(-1);
+    QWindow *window = nullptr;
+    QBENCHMARK {
+        window = WindowStateRegistry::findWindow(winId);
+    }
+    QCOMPARE(window, expected);
+}
+
+QTEST_MAIN(tst_bench_FindWindow)
+
+#include "tst_bench_findwindow.moc"
@@ -0,0 +1,137 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "core/framelesshelper.h"
+#include "core/framezones.h"
+#include "core/systemmetriccache.h"
+#include "core/utilities.h"
+#include <QtCore/qrandom.h>
+#include <QtGui/qwindow.h>
+#include <QtTest/qtest.h>
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+/*!
+    Hit test throughput with the system metrics read on every query, as
+    mapPosToFrameSection() used to, against SystemMetricCache and against
+    FramelessHelper itself, which also keeps the zones until a metric
+    changes.
+ */
+class tst_bench_HitTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void uncachedMetrics();
+    void cachedMetrics();
+    void helper();
+
+private:
+    using MetricGetter = int (*)(const QWindow *, const SystemMetric, const bool, const bool);
+    int classifyAll(MetricGetter getMetric);
+
+    QWindow *m_window = nullptr;
+    FramelessHelper *m_helper = nullptr;
+    QVector<QPoint> m_points;
+};
+
+void tst_bench_HitTest::initTestCase()
+{
+    m_window = new QWindow;
+    m_window->resize(800, 600);
+    m_helper = new FramelessHelper(m_window);
+    m_helper->setWindowSize(m_window->size());
+
+    // Fixed seed, so that every run queries the same points. A third of
+    // them is close to the borders, where most of the hovering happens.
+    QRandomGenerator generator(42);
+    for (int i = 0; i != 1024; ++i) {
+        if (i % 3 == 0) {
+            m_points.append({generator.bounded(800), generator.bounded(12)});
+        } else {
+            m_points.append({generator.bounded(800), generator.bounded(600)});
+        }
+    }
+}
+
+void tst_bench_HitTest::cleanupTestCase()
+{
+    delete m_helper;
+    m_helper = nullptr;
+    delete m_window;
+    m_window = nullptr;
+}
+
+// The metrics are looked up for every point, the way mapPosToFrameSection()
+// did before the cache.
+int tst_bench_HitTest::classifyAll(MetricGetter getMetric)
+{
+    int hits = 0;
+    FrameZones zones;
+    for (const QPoint &point : qAsConst(m_points)) {
+        const int sysBorder = getMetric(m_window, SystemMetric::ResizeBorderThickness, false, false);
+        const int border = qMin(getMetric(m_window, SystemMetric::ResizeBorderThickness, true, false), sysBorder);
+        const int titleBarHeight = getMetric(m_window, SystemMetric::TitleBarHeight, true, false);
+        zones.update(m_window->width(), m_window->height(), border, border * 2, titleBarHeight);
+        hits += (zones.classify(point) != Qt::NoSection) ? 1 : 0;
+    }
+    return hits;
+}
+
+void tst_bench_HitTest::uncachedMetrics()
+{
+    int hits = 0;
+    QBENCHMARK {
+        hits = classifyAll(&Utilities::getSystemMetric);
+    }
+    QVERIFY(hits > 0);
+}
+
+void tst_bench_HitTest::cachedMetrics()
+{
+    int hits = 0;
+    QBENCHMARK {
+        hits = classifyAll(&SystemMetricCache::getSystemMetric);
+    }
+    QVERIFY(hits > 0);
+}
+
+void tst_bench_HitTest::helper()
+{
+    int hits = 0;
+    QBENCHMARK {
+        hits = 0;
+        for (const QPoint &point : qAsConst(m_points)) {
+            hits += (m_helper->mapPosToFrameSection(point) != Qt::NoSection) ? 1 : 0;
+        }
+    }
+    QVERIFY(hits > 0);
+}
+
+QTEST_MAIN(tst_bench_HitTest)
+
+#include "tst_bench_hittest.moc"
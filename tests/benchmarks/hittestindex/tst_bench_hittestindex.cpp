@@ -0,0 +1,204 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "core/hittestindex.h"
+#include <QtCore/qrandom.h>
+#include <QtGui/qregion.h>
+#include <QtTest/qtest.h>
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+/*!
+    Compares the HitTestIndex with the QRegion based path it replaced, for
+    title bars holding 10, 100 and 1000 browser style tabs.
+ */
+class tst_bench_HitTestIndex : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void consistency_data();
+    void consistency();
+    void regionQuery_data();
+    void regionQuery();
+    void regionRebuildAndQuery_data();
+    void regionRebuildAndQuery();
+    void indexQuery_data();
+    void indexQuery();
+    void indexRebuild_data();
+    void indexRebuild();
+
+private:
+    static void addCounts();
+    static QRect titleBarRect(const int count);
+    static QVector<QRect> tabRects(const int count);
+    static QVector<QPoint> queryPoints(const int count);
+    static QRegion titleBarRegion(const int count, const QVector<QRect> &rects);
+};
+
+static const int kTabWidth = 30;
+static const int kTabSpacing = 2;
+static const int kTitleBarHeight = 32;
+static const int kQueryCount = 1024;
+
+void tst_bench_HitTestIndex::addCounts()
+{
+    QTest::addColumn<int>("count");
+    QTest::newRow("10") << 10;
+    QTest::newRow("100") << 100;
+    QTest::newRow("1000") << 1000;
+}
+
+QRect tst_bench_HitTestIndex::titleBarRect(const int count)
+{
+    return {0, 0, count * (kTabWidth + kTabSpacing), kTitleBarHeight};
+}
+
+QVector<QRect> tst_bench_HitTestIndex::tabRects(const int count)
+{
+    QVector<QRect> rects;
+    rects.reserve(count);
+    for (int i = 0; i != count; ++i) {
+        rects.append({i * (kTabWidth + kTabSpacing), 4, kTabWidth, kTitleBarHeight - 4});
+    }
+    return rects;
+}
+
+QVector<QPoint> tst_bench_HitTestIndex::queryPoints(const int count)
+{
+    // Fixed seed, so that every run queries the same points.
+    QRandomGenerator generator(42);
+    const QRect rect = titleBarRect(count);
+    QVector<QPoint> points;
+    points.reserve(kQueryCount);
+    for (int i = 0; i != kQueryCount; ++i) {
+        points.append({generator.bounded(rect.width()), generator.bounded(rect.height())});
+    }
+    return points;
+}
+
+// What titleBarRegion() used to compute on every call.
+QRegion tst_bench_HitTestIndex::titleBarRegion(const int count, const QVector<QRect> &rects)
+{
+    QRegion region(titleBarRect(count));
+    for (const QRect &rect : rects) {
+        region -= rect;
+    }
+    return region;
+}
+
+void tst_bench_HitTestIndex::consistency_data()
+{
+    addCounts();
+}
+
+void tst_bench_HitTestIndex::consistency()
+{
+    QFETCH(int, count);
+    const QVector<QRect> rects = tabRects(count);
+    const QRegion region = titleBarRegion(count, rects);
+    HitTestIndex index;
+    index.build(rects);
+    QCOMPARE(index.size(), count);
+    for (const QPoint &point : queryPoints(count)) {
+        QCOMPARE(index.contains(point), !region.contains(point));
+    }
+}
+
+void tst_bench_HitTestIndex::regionQuery_data()
+{
+    addCounts();
+}
+
+void tst_bench_HitTestIndex::regionQuery()
+{
+    QFETCH(int, count);
+    const QRegion region = titleBarRegion(count, tabRects(count));
+    const QVector<QPoint> points = queryPoints(count);
+    int hits = 0;
+    QBENCHMARK {
+        for (const QPoint &point : points) {
+            hits += region.contains(point) ? 0 : 1;
+        }
+    }
+    QVERIFY(hits > 0);
+}
+
+void tst_bench_HitTestIndex::regionRebuildAndQuery_data()
+{
+    addCounts();
+}
+
+void tst_bench_HitTestIndex::regionRebuildAndQuery()
+{
+    QFETCH(int, count);
+    const QVector<QRect> rects = tabRects(count);
+    const QPoint point = queryPoints(count).constFirst();
+    int hits = 0;
+    QBENCHMARK {
+        hits += titleBarRegion(count, rects).contains(point) ? 0 : 1;
+    }
+    QVERIFY(hits >= 0);
+}
+
+void tst_bench_HitTestIndex::indexQuery_data()
+{
+    addCounts();
+}
+
+void tst_bench_HitTestIndex::indexQuery()
+{
+    QFETCH(int, count);
+    HitTestIndex index;
+    index.build(tabRects(count));
+    const QVector<QPoint> points = queryPoints(count);
+    int hits = 0;
+    QBENCHMARK {
+        for (const QPoint &point : points) {
+            hits += index.contains(point) ? 1 : 0;
+        }
+    }
+    QVERIFY(hits > 0);
+}
+
+void tst_bench_HitTestIndex::indexRebuild_data()
+{
+    addCounts();
+}
+
+void tst_bench_HitTestIndex::indexRebuild()
+{
+    QFETCH(int, count);
+    const QVector<QRect> rects = tabRects(count);
+    HitTestIndex index;
+    QBENCHMARK {
+        index.build(rects);
+    }
+    QCOMPARE(index.size(), count);
+}
+
+QTEST_APPLESS_MAIN(tst_bench_HitTestIndex)
+
+#include "tst_bench_hittestindex.moc"
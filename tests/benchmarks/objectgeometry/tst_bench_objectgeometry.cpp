@@ -0,0 +1,170 @@
+/*
+ * MIT License
+ *
+ * Copyright (C) 2021 by wangwenx190 (Yuhang Zhao)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "core/objectgeometry.h"
+#include <QtTest/qtest.h>
+#include <QtWidgets/qpushbutton.h>
+#include <QtWidgets/qwidget.h>
+#ifdef QT_QUICK_LIB
+#include <QtQuick/qquickitem.h>
+#endif
+
+FRAMELESSHELPER_USE_NAMESPACE
+
+/*!
+    The per call cost of the typed ObjectGeometry accessors, compared with
+    the property() and inherits() based lookups they replaced. The object
+    is nested three levels below its window.
+ */
+class tst_bench_ObjectGeometry : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+    void propertyPath_data();
+    void propertyPath();
+    void typedPath_data();
+    void typedPath();
+
+private:
+    void addObjects();
+
+    QWidget *m_window = nullptr;
+    QWidget *m_button = nullptr;
+#ifdef QT_QUICK_LIB
+    QQuickItem *m_rootItem = nullptr;
+    QQuickItem *m_item = nullptr;
+#endif
+};
+
+// What getHTVObjectRect() and isHitTestVisible() used to do on every call.
+static bool propertyLookup(const QObject *object, QRect *rect)
+{
+    if (!object->isWidgetType() && !object->inherits("QQuickItem")) {
+        return false;
+    }
+    if (!object->property("visible").toBool()) {
+        return false;
+    }
+    QPointF localPos = {object->property("x").toReal(), object->property("y").toReal()};
+    for (QObject *p = object->parent(); p; p = p->parent()) {
+        if (p->parent() == nullptr)
+            break;
+        if (p->isWindowType())
+            break;
+        localPos += {p->property("x").toReal(), p->property("y").toReal()};
+    }
+    *rect = QRect(localPos.toPoint(), QSize(object->property("width").toInt(), object->property("height").toInt()));
+    return true;
+}
+
+void tst_bench_ObjectGeometry::initTestCase()
+{
+    m_window = new QWidget;
+    m_window->resize(800, 600);
+    QWidget *outer = new QWidget(m_window);
+    outer->setGeometry(10, 10, 600, 400);
+    QWidget *inner = new QWidget(outer);
+    inner->setGeometry(20, 20, 400, 200);
+    m_button = new QPushButton(inner);
+    m_button->setGeometry(30, 30, 100, 30);
+    m_window->show();
+
+#ifdef QT_QUICK_LIB
+    m_rootItem = new QQuickItem;
+    m_rootItem->setSize({800, 600});
+    QQuickItem *parent = m_rootItem;
+    for (int i = 0; i != 3; ++i) {
+        auto item = new QQuickItem;
+        item->setParent(parent);
+        item->setParentItem(parent);
+        item->setPosition({10.0 * (i + 1), 10.0 * (i + 1)});
+        item->setSize({400, 200});
+        parent = item;
+    }
+    m_item = parent;
+    m_item->setSize({100, 30});
+#endif
+}
+
+void tst_bench_ObjectGeometry::cleanupTestCase()
+{
+    delete m_window;
+    m_window = nullptr;
+#ifdef QT_QUICK_LIB
+    delete m_rootItem;
+    m_rootItem = nullptr;
+#endif
+}
+
+void tst_bench_ObjectGeometry::addObjects()
+{
+    QTest::addColumn<QObject *>("object");
+    QTest::newRow("widget") << static_cast<QObject *>(m_button);
+#ifdef QT_QUICK_LIB
+    QTest::newRow("quickitem") << static_cast<QObject *>(m_item);
+#endif
+}
+
+void tst_bench_ObjectGeometry::propertyPath_data()
+{
+    addObjects();
+}
+
+void tst_bench_ObjectGeometry::propertyPath()
+{
+    QFETCH(QObject *, object);
+    QRect rect;
+    QBENCHMARK {
+        propertyLookup(object, &rect);
+    }
+    QVERIFY(rect.isValid());
+}
+
+void tst_bench_ObjectGeometry::typedPath_data()
+{
+    addObjects();
+}
+
+void tst_bench_ObjectGeometry::typedPath()
+{
+    QFETCH(QObject *, object);
+    // Resolved once, when the object is registered.
+    const ObjectKind kind = ObjectGeometry::kindOf(object);
+    QVERIFY(kind != ObjectKind::Unknown);
+    QRect rect;
+    QBENCHMARK {
+        if (ObjectGeometry::isVisible(object, kind)) {
+            rect = ObjectGeometry::windowRect(object, kind);
+        }
+    }
+    QVERIFY(rect.isValid());
+}
+
+QTEST_MAIN(tst_bench_ObjectGeometry)
+
+#include "tst_bench_objectgeometry.moc"